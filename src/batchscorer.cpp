@@ -0,0 +1,295 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRIPLEYTZ_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#include "batchscorer.h"
+#include "scoretable.h"
+
+#if defined(TRIPLEYTZ_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TRIPLEYTZ_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TRIPLEYTZ_TARGET_AVX2
+#endif
+
+namespace {
+///
+/// \brief  Score a range of rolls one at a time using the precomputed score table.
+///
+void score_scalar(const RollBatch &rolls, const ScoreBatch &out, size_t first)
+{
+    for (size_t i{first}; i < rolls.count; ++i)
+    {
+        const std::array<int, 5>    faces{rolls.faces[0][i], rolls.faces[1][i], rolls.faces[2][i],
+                                          rolls.faces[3][i], rolls.faces[4][i]};
+        const auto                 &scores{ScoreTable::scores(ScoreTable::index(faces))};
+
+        for (size_t c{0}; c < category_count; ++c)
+            out.scores[c][i] = scores[c];
+    }
+}
+
+#if defined(TRIPLEYTZ_X86)
+///
+/// \brief  Score rolls sixteen at a time, one roll per byte lane.
+/// \return The index of the first roll that was not scored.
+///
+size_t score_sse2(const RollBatch &rolls, const ScoreBatch &out)
+{
+    constexpr size_t    width{16};
+    const __m128i       zero{_mm_setzero_si128()};
+    const __m128i       all{_mm_cmpeq_epi8(zero, zero)};
+    size_t              i{0};
+
+    for (; i + width <= rolls.count; i += width)
+    {
+        __m128i dice[5];
+        __m128i counts[6];
+        __m128i uppers[6];
+        __m128i sum{zero};
+
+        for (size_t d{0}; d < 5; ++d)
+        {
+            dice[d] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rolls.faces[d] + i));
+            sum = _mm_add_epi8(sum, dice[d]);
+        }
+
+        __m128i max_count{zero};
+        __m128i has_three{zero};
+        __m128i has_two{zero};
+
+        for (int f{0}; f < 6; ++f)
+        {
+            const __m128i   face{_mm_set1_epi8(static_cast<char>(f + 1))};
+
+            counts[f] = zero;
+            uppers[f] = zero;
+            for (const auto &die : dice)
+            {
+                const __m128i   match{_mm_cmpeq_epi8(die, face)};
+
+                counts[f] = _mm_sub_epi8(counts[f], match);
+                uppers[f] = _mm_add_epi8(uppers[f], _mm_and_si128(match, face));
+            }
+            max_count = _mm_max_epu8(max_count, counts[f]);
+            has_three = _mm_or_si128(has_three, _mm_cmpeq_epi8(counts[f], _mm_set1_epi8(3)));
+            has_two = _mm_or_si128(has_two, _mm_cmpeq_epi8(counts[f], _mm_set1_epi8(2)));
+        }
+
+        __m128i present[6];
+        __m128i single[6];
+
+        for (int f{0}; f < 6; ++f)
+        {
+            present[f] = _mm_xor_si128(_mm_cmpeq_epi8(counts[f], zero), all);
+            single[f] = _mm_cmpeq_epi8(counts[f], _mm_set1_epi8(1));
+        }
+
+        const __m128i   three_kind{_mm_cmpeq_epi8(_mm_max_epu8(max_count, _mm_set1_epi8(3)), max_count)};
+        const __m128i   four_kind{_mm_cmpeq_epi8(_mm_max_epu8(max_count, _mm_set1_epi8(4)), max_count)};
+        const __m128i   five_kind{_mm_cmpeq_epi8(max_count, _mm_set1_epi8(5))};
+        const __m128i   run_low{_mm_and_si128(_mm_and_si128(present[0], present[1]), _mm_and_si128(present[2], present[3]))};
+        const __m128i   run_mid{_mm_and_si128(_mm_and_si128(present[1], present[2]), _mm_and_si128(present[3], present[4]))};
+        const __m128i   run_high{_mm_and_si128(_mm_and_si128(present[2], present[3]), _mm_and_si128(present[4], present[5]))};
+        const __m128i   singles_mid{_mm_and_si128(_mm_and_si128(single[1], single[2]), _mm_and_si128(single[3], single[4]))};
+        const __m128i   large{_mm_and_si128(singles_mid, _mm_or_si128(single[0], single[5]))};
+
+        const __m128i   scores[category_count]{
+            uppers[0], uppers[1], uppers[2], uppers[3], uppers[4], uppers[5],
+            _mm_and_si128(three_kind, sum),
+            _mm_and_si128(four_kind, sum),
+            _mm_and_si128(_mm_and_si128(has_three, has_two), _mm_set1_epi8(25)),
+            _mm_and_si128(_mm_or_si128(_mm_or_si128(run_low, run_mid), run_high), _mm_set1_epi8(30)),
+            _mm_and_si128(large, _mm_set1_epi8(40)),
+            _mm_and_si128(five_kind, _mm_set1_epi8(50)),
+            sum
+        };
+
+        for (size_t c{0}; c < category_count; ++c)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out.scores[c] + i), scores[c]);
+    }
+
+    return i;
+}
+
+///
+/// \brief  Score rolls thirty-two at a time, one roll per byte lane.
+/// \return The index of the first roll that was not scored.
+///
+TRIPLEYTZ_TARGET_AVX2
+size_t score_avx2(const RollBatch &rolls, const ScoreBatch &out)
+{
+    constexpr size_t    width{32};
+    const __m256i       zero{_mm256_setzero_si256()};
+    const __m256i       all{_mm256_cmpeq_epi8(zero, zero)};
+    size_t              i{0};
+
+    for (; i + width <= rolls.count; i += width)
+    {
+        __m256i dice[5];
+        __m256i counts[6];
+        __m256i uppers[6];
+        __m256i sum{zero};
+
+        for (size_t d{0}; d < 5; ++d)
+        {
+            dice[d] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rolls.faces[d] + i));
+            sum = _mm256_add_epi8(sum, dice[d]);
+        }
+
+        __m256i max_count{zero};
+        __m256i has_three{zero};
+        __m256i has_two{zero};
+
+        for (int f{0}; f < 6; ++f)
+        {
+            const __m256i   face{_mm256_set1_epi8(static_cast<char>(f + 1))};
+
+            counts[f] = zero;
+            uppers[f] = zero;
+            for (const auto &die : dice)
+            {
+                const __m256i   match{_mm256_cmpeq_epi8(die, face)};
+
+                counts[f] = _mm256_sub_epi8(counts[f], match);
+                uppers[f] = _mm256_add_epi8(uppers[f], _mm256_and_si256(match, face));
+            }
+            max_count = _mm256_max_epu8(max_count, counts[f]);
+            has_three = _mm256_or_si256(has_three, _mm256_cmpeq_epi8(counts[f], _mm256_set1_epi8(3)));
+            has_two = _mm256_or_si256(has_two, _mm256_cmpeq_epi8(counts[f], _mm256_set1_epi8(2)));
+        }
+
+        __m256i present[6];
+        __m256i single[6];
+
+        for (int f{0}; f < 6; ++f)
+        {
+            present[f] = _mm256_xor_si256(_mm256_cmpeq_epi8(counts[f], zero), all);
+            single[f] = _mm256_cmpeq_epi8(counts[f], _mm256_set1_epi8(1));
+        }
+
+        const __m256i   three_kind{_mm256_cmpeq_epi8(_mm256_max_epu8(max_count, _mm256_set1_epi8(3)), max_count)};
+        const __m256i   four_kind{_mm256_cmpeq_epi8(_mm256_max_epu8(max_count, _mm256_set1_epi8(4)), max_count)};
+        const __m256i   five_kind{_mm256_cmpeq_epi8(max_count, _mm256_set1_epi8(5))};
+        const __m256i   run_low{_mm256_and_si256(_mm256_and_si256(present[0], present[1]), _mm256_and_si256(present[2], present[3]))};
+        const __m256i   run_mid{_mm256_and_si256(_mm256_and_si256(present[1], present[2]), _mm256_and_si256(present[3], present[4]))};
+        const __m256i   run_high{_mm256_and_si256(_mm256_and_si256(present[2], present[3]), _mm256_and_si256(present[4], present[5]))};
+        const __m256i   singles_mid{_mm256_and_si256(_mm256_and_si256(single[1], single[2]), _mm256_and_si256(single[3], single[4]))};
+        const __m256i   large{_mm256_and_si256(singles_mid, _mm256_or_si256(single[0], single[5]))};
+
+        const __m256i   scores[category_count]{
+            uppers[0], uppers[1], uppers[2], uppers[3], uppers[4], uppers[5],
+            _mm256_and_si256(three_kind, sum),
+            _mm256_and_si256(four_kind, sum),
+            _mm256_and_si256(_mm256_and_si256(has_three, has_two), _mm256_set1_epi8(25)),
+            _mm256_and_si256(_mm256_or_si256(_mm256_or_si256(run_low, run_mid), run_high), _mm256_set1_epi8(30)),
+            _mm256_and_si256(large, _mm256_set1_epi8(40)),
+            _mm256_and_si256(five_kind, _mm256_set1_epi8(50)),
+            sum
+        };
+
+        for (size_t c{0}; c < category_count; ++c)
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out.scores[c] + i), scores[c]);
+    }
+
+    return i;
+}
+
+bool cpu_has_avx2() noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuid(regs, 1);
+    constexpr int   osxsave{1 << 27};
+    constexpr int   avx{1 << 28};
+    if ((regs[2] & (osxsave | avx)) != (osxsave | avx))
+        return false;
+    if ((_xgetbv(0) & 0x6) != 0x6)      // XMM and YMM state enabled by the OS
+        return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif  // TRIPLEYTZ_X86
+}   // anonymous namespace
+
+///
+/// \brief BatchScorer::best_isa    Determine the fastest instruction set available on this processor.
+/// \return The fastest supported \c Isa value.
+///
+BatchScorer::Isa BatchScorer::best_isa() noexcept
+{
+#if defined(TRIPLEYTZ_X86)
+    static const Isa    isa{cpu_has_avx2() ? Isa::Avx2 : Isa::Sse2};
+
+    return isa;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+///
+/// \brief BatchScorer::score   Score a batch of rolls using the fastest available instruction set.
+/// \param rolls    The rolls to be scored.
+/// \param out      Receives the scores of each roll in every category.
+///
+void BatchScorer::score(const RollBatch &rolls, const ScoreBatch &out)
+{
+    score(rolls, out, best_isa());
+}
+
+///
+/// \brief BatchScorer::score   Score a batch of rolls using a specific instruction set.
+/// \param rolls    The rolls to be scored.
+/// \param out      Receives the scores of each roll in every category.
+/// \param isa      The instruction set to use. It must be supported by the processor.
+///
+/// Requesting an instruction set that does not exist on the target
+/// architecture falls back to scalar scoring.
+void BatchScorer::score(const RollBatch &rolls, const ScoreBatch &out, Isa isa)
+{
+    size_t  first{0};
+
+#if defined(TRIPLEYTZ_X86)
+    if (isa == Isa::Avx2)
+        first = score_avx2(rolls, out);
+    else if (isa == Isa::Sse2)
+        first = score_sse2(rolls, out);
+#else
+    (void)isa;
+#endif
+
+    score_scalar(rolls, out, first);
+}
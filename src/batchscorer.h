@@ -0,0 +1,79 @@
+#ifndef BATCHSCORER_H
+#define BATCHSCORER_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gamescorer.h"
+
+///
+/// \brief A structure-of-arrays buffer of rolls to be scored together.
+///
+/// \c faces[d][i] is the face value, one through six, of die \c d in roll \c i.
+///
+struct RollBatch
+{
+    std::array<const std::uint8_t *, 5> faces;
+    size_t                              count;
+};
+
+///
+/// \brief A structure-of-arrays buffer receiving the scores of a RollBatch.
+///
+/// \c scores[c][i] receives the score of roll \c i in the category whose
+/// \c Category value is \c c. Each array must hold at least as many elements
+/// as there are rolls in the batch.
+///
+struct ScoreBatch
+{
+    std::array<std::uint8_t *, category_count>  scores;
+};
+
+///
+/// \brief Scores many rolls in all thirteen categories at once.
+///
+/// On x86 processors the rolls are scored 16 at a time with SSE2, or 32 at a
+/// time with AVX2 when the processor supports it. Elsewhere, and for any rolls
+/// left over at the end of a batch, each roll is scored through \c ScoreTable.
+/// All paths produce identical results.
+///
+class BatchScorer
+{
+public:
+    ///
+    /// \brief The instruction sets a batch can be scored with.
+    ///
+    enum class Isa
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    static void score(const RollBatch &rolls, const ScoreBatch &out);
+    static void score(const RollBatch &rolls, const ScoreBatch &out, Isa isa);
+
+    static Isa best_isa() noexcept;
+};
+
+#endif // BATCHSCORER_H
@@ -0,0 +1,286 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "columnsolver.h"
+#include "gameengine.h"
+#include "scoretable.h"
+
+namespace {
+constexpr unsigned  UpperMask{0x3F};
+
+constexpr bool is_upper(Category category) noexcept
+{
+    return category <= Category::Sixes;
+}
+
+///
+/// \brief  Determine which capped upper subtotals can be reached from each set of filled upper categories.
+///
+std::array<std::array<bool, ColumnSolver::upper_cap + 1>, 64> make_reachable()
+{
+    std::array<std::array<bool, ColumnSolver::upper_cap + 1>, 64>  reachable{};
+
+    reachable[0][0] = true;
+    for (unsigned mask{1}; mask < 64; ++mask)
+    {
+        unsigned    face{0};
+
+        while (!(mask & (1u << face)))
+            ++face;
+
+        const auto &previous{reachable[mask & ~(1u << face)]};
+
+        for (int upper{0}; upper <= ColumnSolver::upper_cap; ++upper)
+            if (previous[upper])
+                for (int count{0}; count <= 5; ++count)
+                    reachable[mask][std::min(ColumnSolver::upper_cap, upper + count * static_cast<int>(face + 1))] = true;
+    }
+
+    return reachable;
+}
+}   // anonymous namespace
+
+///
+/// \brief ColumnState::after   Determine the state of a column after scoring a category.
+/// \param category The category scored. It must not already be filled.
+/// \param score    The score earned.
+///
+ColumnState ColumnState::after(Category category, int score) const noexcept
+{
+    ColumnState next{*this};
+
+    next.filled = static_cast<std::uint16_t>(filled | (1u << static_cast<unsigned>(category)));
+    if (is_upper(category))
+        next.upper = static_cast<std::uint8_t>(std::min(ColumnSolver::upper_cap, upper + score));
+
+    return next;
+}
+
+///
+/// \brief ColumnState::bonus_for   Determine the bonus earned by scoring a category.
+/// \param category The category scored.
+/// \param score    The score earned.
+/// \return The upper section bonus if this score reaches the threshold, zero otherwise.
+///
+int ColumnState::bonus_for(Category category, int score) const noexcept
+{
+    if (is_upper(category) && upper < GameEngine::upper_bonus_threshold && upper + score >= GameEngine::upper_bonus_threshold)
+        return GameEngine::upper_bonus;
+
+    return 0;
+}
+
+///
+/// \brief ColumnSolver::ColumnSolver   Construct an unsolved ColumnSolver, with all values zero.
+///
+ColumnSolver::ColumnSolver()
+  : _values(state_count, 0.0f)
+  , _table{_values.data()}
+{}
+
+///
+/// \brief ColumnSolver::is_reachable   Determine whether a state can occur in a game.
+/// \param state    The state to be checked.
+/// \return false if no scores in the filled upper categories add up to the state's subtotal.
+///
+bool ColumnSolver::is_reachable(const ColumnState &state) noexcept
+{
+    static const auto   reachable{make_reachable()};
+
+    return reachable[state.filled & UpperMask][state.upper];
+}
+
+///
+/// \brief ColumnSolver::score_values   Calculate the value of each final roll of a turn.
+/// \param state    The state of the column at the start of the turn.
+/// \param out      Receives, for each roll, the best total of the score earned,
+///                 any bonus, and the expected score of the rest of the column.
+///
+/// The state must have at least one open category.
+void ColumnSolver::score_values(const ColumnState &state, RollValues &out) const noexcept
+{
+    std::array<Category, category_count>    open;
+    size_t                                  open_count{0};
+
+    for (size_t c{0}; c < category_count; ++c)
+        if (!state.is_filled(static_cast<Category>(c)))
+            open[open_count++] = static_cast<Category>(c);
+
+    for (size_t roll{0}; roll < out.size(); ++roll)
+    {
+        const auto &scores{ScoreTable::scores(static_cast<int>(roll))};
+        float       best{-1.0f};
+
+        for (size_t i{0}; i < open_count; ++i)
+        {
+            const int   score{scores[static_cast<size_t>(open[i])]};
+            const float total{  static_cast<float>(score + state.bonus_for(open[i], score))
+                              + value(state.after(open[i], score))};
+
+            best = std::max(best, total);
+        }
+        out[roll] = best;
+    }
+}
+
+///
+/// \brief ColumnSolver::turn_value Calculate the expected score of the rest of a column from the start of a turn.
+/// \param state    The state of the column. It must have at least one open category.
+///
+/// Unlike \c value(), this function does not depend on \c state having been solved,
+/// only on the states that follow it.
+float ColumnSolver::turn_value(const ColumnState &state) const noexcept
+{
+    RollValues  final_roll;
+    RollValues  second_roll;
+    RollValues  first_roll;
+
+    score_values(state, final_roll);
+    TurnEvaluator::reroll_values(final_roll, second_roll);
+    TurnEvaluator::reroll_values(second_roll, first_roll);
+
+    return TurnEvaluator::roll_expectation(first_roll);
+}
+
+///
+/// \brief ColumnSolver::best_category  Determine the best category to score a final roll in.
+/// \param state    The state of the column. It must have at least one open category.
+/// \param roll     The index of the roll.
+///
+Category ColumnSolver::best_category(const ColumnState &state, int roll) const noexcept
+{
+    const auto &scores{ScoreTable::scores(roll)};
+    Category    best_category{Category::Chance};
+    float       best{-1.0f};
+
+    for (size_t c{0}; c < category_count; ++c)
+    {
+        const auto  category{static_cast<Category>(c)};
+
+        if (!state.is_filled(category))
+        {
+            const int   score{scores[c]};
+            const float total{static_cast<float>(score + state.bonus_for(category, score)) + value(state.after(category, score))};
+
+            if (total > best)
+            {
+                best = total;
+                best_category = category;
+            }
+        }
+    }
+
+    return best_category;
+}
+
+///
+/// \brief ColumnSolver::solve  Compute the value of every reachable state.
+/// \param threads  The number of threads to use, or zero to use one per hardware thread.
+///
+void ColumnSolver::solve(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::array<std::vector<std::uint16_t>, category_count + 1>  levels;
+
+    for (unsigned filled{0}; filled < (1u << category_count); ++filled)
+        levels[std::bitset<category_count>{filled}.count()].push_back(static_cast<std::uint16_t>(filled));
+
+    _file.reset();
+    _values.assign(state_count, 0.0f);
+    _table = _values.data();
+
+    // A full column is worth nothing more, so work back from one open category.
+    for (size_t level{category_count}; level-- > 0;)
+    {
+        const auto             &masks{levels[level]};
+        const size_t            work{masks.size() * (upper_cap + 1)};
+        std::atomic<size_t>     next{0};
+        std::vector<std::thread>    pool;
+
+        auto    worker = [&]()
+        {
+            constexpr size_t    chunk{64};
+
+            for (size_t first{next.fetch_add(chunk)}; first < work; first = next.fetch_add(chunk))
+            {
+                for (size_t i{first}; i < std::min(work, first + chunk); ++i)
+                {
+                    const ColumnState   state{masks[i / (upper_cap + 1)], static_cast<std::uint8_t>(i % (upper_cap + 1))};
+
+                    if (is_reachable(state))
+                        _values[state_index(state)] = turn_value(state);
+                }
+            }
+        };
+
+        for (unsigned t{1}; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &t : pool)
+            t.join();
+    }
+}
+
+///
+/// \brief ColumnSolver::save   Write the value table to a strategy file.
+/// \param path The location of the file.
+/// \return true if the file was written, false otherwise.
+///
+bool ColumnSolver::save(const std::string &path) const
+{
+    return StrategyFile::write(path, *this);
+}
+
+///
+/// \brief ColumnSolver::load   Use the value table in a strategy file written by \c save().
+/// \param path The location of the file.
+/// \return true if the table was mapped, false if the file is missing or not a column table.
+///
+/// The file is mapped into memory rather than read, so loading takes constant
+/// time and the table's pages are shared with other processes using it.
+bool ColumnSolver::load(const std::string &path)
+{
+    auto    file{std::make_unique<StrategyFile>()};
+
+    if (   !file->open(path)
+        || file->kind() != StrategyFile::Kind::Column
+        || file->entry_count() != state_count
+        || file->slot_count() != state_count)
+        return false;
+
+    _file = std::move(file);
+    _table = _file->column_values();
+    _values.clear();
+    _values.shrink_to_fit();
+
+    return true;
+}
@@ -0,0 +1,129 @@
+#ifndef COLUMNSOLVER_H
+#define COLUMNSOLVER_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gamescorer.h"
+#include "strategyfile.h"
+#include "turnevaluator.h"
+
+///
+/// \brief The state of a single score column between turns.
+///
+/// Only two things about a column affect how the rest of it can be played:
+/// which categories have been filled, and the upper section subtotal. The
+/// subtotal is capped at the bonus threshold, since beyond that it no longer
+/// matters.
+///
+struct ColumnState
+{
+    std::uint16_t   filled{0};      // bit n is set when Category n has been scored
+    std::uint8_t    upper{0};       // upper section subtotal, capped at 63
+
+    constexpr bool is_filled(Category category) const noexcept
+    {
+        return (filled >> static_cast<unsigned>(category)) & 1;
+    }
+    constexpr bool is_complete() const noexcept
+    {
+        return filled == (1u << category_count) - 1;
+    }
+
+    ColumnState after(Category category, int score) const noexcept;
+    int bonus_for(Category category, int score) const noexcept;
+};
+
+///
+/// \brief Computes the optimal strategy for a single score column.
+///
+/// The solver finds, for every ColumnState, the expected score of the rest
+/// of the column when every later decision is made to maximize that
+/// expectation. States are processed in order of decreasing number of filled
+/// categories; all states with the same number of filled categories depend
+/// only on states with more, so each such level is spread across threads.
+///
+class ColumnSolver
+{
+public:
+    static constexpr int    upper_cap{63};
+    static constexpr size_t state_count{(size_t{1} << category_count) * (upper_cap + 1)};
+
+    ///
+    /// \brief  Retrieve the position of a state in the value table.
+    ///
+    static constexpr size_t state_index(const ColumnState &state) noexcept
+    {
+        return (size_t{state.filled} << 6) | state.upper;
+    }
+
+    ColumnSolver();
+
+    ColumnSolver(const ColumnSolver &) = delete;
+    ColumnSolver &operator=(const ColumnSolver &) = delete;
+
+    void solve(unsigned threads = 0);
+
+    ///
+    /// \brief  Retrieve the expected score of the rest of a column under optimal play.
+    /// \param state    The state of the column at the start of a turn.
+    ///
+    float value(const ColumnState &state) const noexcept
+    {
+        return _table[state_index(state)];
+    }
+
+    ///
+    /// \brief  Retrieve the expected score of a whole column under optimal play.
+    ///
+    float expected_score() const noexcept
+    {
+        return value(ColumnState{});
+    }
+
+    ///
+    /// \brief  Retrieve the table of \c state_count values, indexed by \c state_index().
+    ///
+    const float *values() const noexcept
+    {
+        return _table;
+    }
+
+    void score_values(const ColumnState &state, RollValues &out) const noexcept;
+    float turn_value(const ColumnState &state) const noexcept;
+    Category best_category(const ColumnState &state, int roll) const noexcept;
+
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+
+    static bool is_reachable(const ColumnState &state) noexcept;
+
+private:
+    std::vector<float>              _values;    // the table when solved in this process
+    std::unique_ptr<StrategyFile>   _file;      // the table when loaded from a file
+    const float                    *_table;
+};
+
+#endif // COLUMNSOLVER_H
@@ -17,155 +17,546 @@
 * with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
 **************************************************************************/
 
+#include <QByteArray>
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
 #include <QDateTime>
-#include <QFileInfo>
+#include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QSaveFile>
 #include <QString>
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <utility>
 #include <vector>
 
 #include "config.h"
 
 namespace {
     constexpr const char *LastUsedName{"last_used_name"};
+    constexpr const char *PlayerId{"player_id"};
     constexpr const char *MaxHighScores{"max_high_scores"};
+    constexpr const char *ScoresSize{"scores_size"};
     constexpr const char *HighScores{"high_scores"};
     constexpr const char *Score{"score"};
     constexpr const char *When{"when"};
     constexpr const char *Name{"name"};
+
+    constexpr char          Magic[8]{'T', 'Y', 'T', 'Z', 'C', 'O', 'N', 'F'};
+    constexpr std::uint32_t Version{1};
+    constexpr std::uint32_t ByteOrder{0x01020304};
+
+    ///
+    /// \brief The ids of the sections of a configuration file.
+    ///
+    enum class SectionId : std::uint32_t
+    {
+        Settings = 1,   // a map of the settings
+        HighScores,     // an array of [score, when, name] arrays, from the highest score down
+    };
+
+    ///
+    /// \brief The fixed header at the start of every configuration file.
+    ///
+    struct Header
+    {
+        char            magic[8];
+        std::uint32_t   version;
+        std::uint32_t   byte_order;         // detects files written on a machine of different endianness
+        std::uint32_t   section_count;      // the number of entries in the index that follows
+        std::uint32_t   reserved;
+    };
+
+    ///
+    /// \brief An entry in the index of sections that follows the header.
+    ///
+    struct Section
+    {
+        SectionId       id;
+        std::uint32_t   size;
+        std::uint64_t   offset;             // from the start of the file
+    };
+
+    static_assert(sizeof(Header) == 24);
+    static_assert(sizeof(Section) == 16);
+
+    ///
+    /// \brief Read a text string, which may come in chunks.
+    /// \param reader   The reader, positioned on the string.
+    /// \param text     Receives the string.
+    /// \return true if the string was read, false otherwise.
+    ///
+    bool read_string(QCborStreamReader &reader, QString &text)
+    {
+        if (!reader.isString())
+            return false;
+
+        auto    chunk{reader.readString()};
+
+        text.clear();
+        while (chunk.status == QCborStreamReader::Ok)
+        {
+            text += chunk.data;
+            chunk = reader.readString();
+        }
+
+        return chunk.status == QCborStreamReader::EndOfString;
+    }
+
+    ///
+    /// \brief Read an integer.
+    /// \param reader   The reader, positioned on the integer.
+    /// \param value    Receives the integer.
+    /// \return true if the integer was read, false otherwise.
+    ///
+    bool read_integer(QCborStreamReader &reader, qint64 &value)
+    {
+        if (!reader.isInteger())
+            return false;
+
+        value = reader.toInteger();
+
+        return reader.next();
+    }
 }
 
 ///
 /// \brief Config::load Load the configuration settings and high scores
 /// collection from the file.
 ///
-/// The configuration data is stored in a JSON-format file.
+/// Only the settings and the high scores are read from the configuration
+/// file. Of the leaderboard's own file, only the scores added since the
+/// configuration was saved are read, as when the game stops before the
+/// configuration is saved; usually there are none. The rest of the history
+/// stays in the file.
+///
+/// A configuration file in the JSON format of earlier versions is read and
+/// saved again in the binary format. Such files from before there was a
+/// leaderboard hold the high scores themselves; when there is no leaderboard
+/// yet, those scores are moved into a new one.
+///
+/// A player who has no id yet is given a random one, which is saved at once
+/// so that it stays the same from one session to the next.
+///
+/// A binary configuration file that cannot be read, such as one from a later
+/// version or one that is damaged, is left as it is: the player is given no
+/// id, and nothing is saved over the file.
 void Config::load()
 {
-    QFileInfo   fi(_path);
+    QFile                   file{_path};
+    std::vector<HighScore>  legacy_scores;
+    bool                    changed{false};
 
-    if (fi.exists() && fi.isFile())
+    _scores.clear();
+    if (file.open(QIODevice::ReadOnly))
     {
-        try
-        {
-            QFile   file{_path};
+        const QByteArray    magic{file.peek(sizeof(Magic))};
 
-            if (file.open(QIODevice::ReadOnly | QIODevice::Text))
-            {
-                QByteArray      json{file.readAll()};
-                QJsonParseError err;
-                QJsonDocument   doc = QJsonDocument::fromJson(json, &err);
-
-                if (err.error == QJsonParseError::NoError && doc.isObject())
-                {
-                    auto    obj{doc.object()};
-
-                    if (obj.contains(LastUsedName) && obj[LastUsedName].isString())
-                        _last_used_name = obj[LastUsedName].toString();
-                    if (obj.contains(MaxHighScores) && obj[MaxHighScores].isDouble())
-                        _max_high_scores = obj[MaxHighScores].toInt();
-                    clear_high_scores();
-                    if (obj.contains(HighScores) && obj[HighScores].isArray())
-                    {
-                        const QJsonArray  array = obj[HighScores].toArray();    // Avoid initializer-list constructor
-
-                        for (int ndx{0}; ndx < array.size(); ++ndx)
-                        {
-                            QJsonObject elem{array[ndx].toObject()};
-
-                            if (   elem.contains(Score) && elem[Score].isDouble()
-                                && elem.contains(When) && elem[When].isString()
-                                && elem.contains(Name) && elem[Name].isString())
-                            {
-                                _scores.emplace_back(elem[Score].toInt(),
-                                                     QDateTime::fromString(elem[When].toString(), Qt::ISODate),
-                                                     elem[Name].toString());
-                            }
-                        }
-                    }
-                }
-            }
+        if (magic.size() != static_cast<qsizetype>(sizeof(Magic)) || !std::equal(std::begin(Magic), std::end(Magic), magic.constData()))
+        {
+            read_json(file.readAll(), legacy_scores);
+            changed = true;
         }
-        catch (...)
+        else if (!read(file))
         {
-            // do nothing. can't read the config data.
+            _scores.clear();
+            _unreadable = true;
         }
     }
+
+    const auto  scores_size{_scores_size};
+
+    load_leaderboard();
+    if (_leaderboard.missing())
+        for (const auto &score : legacy_scores)
+            add_high_score(score.score, score.name, score.when);
+    if (_scores_size != scores_size)
+        changed = true;
+
+    if (_player_id == 0 && !_unreadable)
+    {
+        while (_player_id == 0)
+            _player_id = QRandomGenerator::system()->generate64();
+        changed = true;
+    }
+
+    if (changed)
+        save();
 }
 
 ///
-/// \brief Config::save Store the configuration and high scores collection
-/// to the file
+/// \brief Config::read Read a configuration file in the binary format.
+/// \param file The open file.
+/// \return true if the file was read, false if it is not a configuration file
+///         of this version or it is damaged.
 ///
-void Config::save() const
+/// Sections the file does not have keep their defaults, and sections this
+/// version does not know are skipped.
+bool Config::read(QFile &file)
 {
-    try
+    Header  header;
+
+    if (   file.read(reinterpret_cast<char *>(&header), sizeof(header)) != static_cast<qint64>(sizeof(header))
+        || !std::equal(std::begin(Magic), std::end(Magic), header.magic)
+        || header.version != Version
+        || header.byte_order != ByteOrder
+        || header.section_count > 64)
+        return false;
+
+    std::vector<Section>    index(header.section_count);
+    const auto              index_size{static_cast<qint64>(index.size() * sizeof(Section))};
+
+    if (file.read(reinterpret_cast<char *>(index.data()), index_size) != index_size)
+        return false;
+
+    for (const auto &section : index)
     {
-        QFile   file(_path);
+        if (section.id != SectionId::Settings && section.id != SectionId::HighScores)
+            continue;
+        const auto  file_size{static_cast<std::uint64_t>(file.size())};
 
-        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
-        {
-            QJsonObject     obj;
+        if (   section.offset > file_size
+            || section.size > file_size - section.offset
+            || !file.seek(static_cast<qint64>(section.offset)))
+            return false;
 
-            obj[LastUsedName] = _last_used_name;
-            obj[MaxHighScores] = static_cast<int>(_max_high_scores);
+        const QByteArray    cbor{file.read(section.size)};
 
-            QJsonArray  scores;
-            size_t  count = std::min(_scores.size(), _max_high_scores);
-            for (size_t i{0}; i < count; ++i)
-            {
-                QJsonObject score;
+        if (section.id == SectionId::Settings ? !read_settings(cbor) : !read_high_scores(cbor))
+            return false;
+    }
 
-                score[Score] = _scores[i].score;
-                score[When] = _scores[i].when.toString(Qt::ISODate);
-                score[Name] = _scores[i].name;
+    return true;
+}
 
-                scores.append(score);
-            }
+///
+/// \brief Config::read_settings    Read the settings section of a configuration file.
+/// \param cbor The section.
+/// \return true if the section was read, false if it is damaged.
+///
+bool Config::read_settings(const QByteArray &cbor)
+{
+    QCborStreamReader   reader{cbor};
 
-            obj[HighScores] = scores;
+    if (!reader.isMap() || !reader.enterContainer())
+        return false;
 
-            file.write(QJsonDocument(obj).toJson());
+    while (reader.lastError() == QCborError::NoError && reader.hasNext())
+    {
+        QString key;
+        qint64  value;
+
+        if (!read_string(reader, key))
+            return false;
+        if (key == LastUsedName && reader.isString())
+        {
+            if (!read_string(reader, _last_used_name))
+                return false;
+        }
+        else if (key == PlayerId && reader.isUnsignedInteger())
+        {
+            _player_id = reader.toUnsignedInteger();
+            reader.next();
+        }
+        else if (key == MaxHighScores && read_integer(reader, value))
+        {
+            _max_high_scores = static_cast<size_t>(std::max<qint64>(value, 0));
+        }
+        else if (key == ScoresSize && reader.isUnsignedInteger())
+        {
+            _scores_size = reader.toUnsignedInteger();
+            reader.next();
+        }
+        else if (!reader.next())    // a setting this version does not know
+        {
+            return false;
         }
     }
-    catch (...)
+
+    return reader.lastError() == QCborError::NoError && reader.leaveContainer();
+}
+
+///
+/// \brief Config::read_high_scores Read the high scores section of a configuration file.
+/// \param cbor The section.
+/// \return true if the section was read, false if it is damaged.
+///
+bool Config::read_high_scores(const QByteArray &cbor)
+{
+    QCborStreamReader   reader{cbor};
+
+    if (!reader.isArray() || !reader.enterContainer())
+        return false;
+
+    while (reader.lastError() == QCborError::NoError && reader.hasNext())
     {
-        // do nothing. can't save the config data
+        qint64  score;
+        qint64  when;
+        QString name;
+
+        if (   !reader.isArray() || !reader.enterContainer()
+            || !read_integer(reader, score)
+            || !read_integer(reader, when)
+            || !read_string(reader, name)
+            || !reader.leaveContainer())
+            return false;
+        _scores.emplace_back(static_cast<int>(score), QDateTime::fromMSecsSinceEpoch(when), name);
     }
+
+    return reader.lastError() == QCborError::NoError && reader.leaveContainer();
 }
 
 ///
-/// \brief Config::add_high_score   Add a score to the collection of high scores.
-/// \param score    The score to be added to the high scores collection
-/// \param name     The name of the player that attained the score
-/// \param datetime The data and time the score occurred
-/// \return true if the score was successfully added, false otherwise.
+/// \brief Config::read_json    Read a configuration file in the JSON format of earlier versions.
+/// \param json             The contents of the file.
+/// \param legacy_scores    Receives the high scores, if the file holds them.
+/// \return true if the file was read, false otherwise.
 ///
-/// It is usually not an error for this function to fail. The most likely cause
-/// is that there is no more room in the collection for high scores as determined
-/// by the configuration's setting for the maximum number of high scores allowed.
-bool Config::add_high_score(int score, const QString &name, QDateTime datetime/* = QDateTime::currentDateTime()*/)
+bool Config::read_json(const QByteArray &json, std::vector<HighScore> &legacy_scores)
 {
-    if (_max_high_scores < 1)
+    QJsonParseError err;
+    QJsonDocument   doc = QJsonDocument::fromJson(json, &err);
+
+    if (err.error != QJsonParseError::NoError || !doc.isObject())
         return false;
 
-    auto pos = std::find_if(begin(_scores), end(_scores), [&score](const HighScore &hs) { return hs.score < score; });
+    auto    obj{doc.object()};
 
-    if (pos == end(_scores))
+    if (obj.contains(LastUsedName) && obj[LastUsedName].isString())
+        _last_used_name = obj[LastUsedName].toString();
+    if (obj.contains(PlayerId) && obj[PlayerId].isString())
+        _player_id = obj[PlayerId].toString().toULongLong(nullptr, 16);
+    if (obj.contains(MaxHighScores) && obj[MaxHighScores].isDouble())
+        _max_high_scores = obj[MaxHighScores].toInt();
+    if (obj.contains(HighScores) && obj[HighScores].isArray())
     {
-        if (_scores.size() >= _max_high_scores)
-            return false;
-        _scores.emplace_back(score, datetime, name);
-        return true;
+        const QJsonArray  array = obj[HighScores].toArray();    // Avoid initializer-list constructor
+
+        for (int ndx{0}; ndx < array.size(); ++ndx)
+        {
+            QJsonObject elem{array[ndx].toObject()};
+
+            if (   elem.contains(Score) && elem[Score].isDouble()
+                && elem.contains(When) && elem[When].isString()
+                && elem.contains(Name) && elem[Name].isString())
+            {
+                legacy_scores.emplace_back(elem[Score].toInt(),
+                                           QDateTime::fromString(elem[When].toString(), Qt::ISODate),
+                                           elem[Name].toString());
+            }
+        }
+    }
+
+    return true;
+}
+
+///
+/// \brief Config::load_leaderboard Bring the high scores up to date with the leaderboard, and open it to add scores.
+///
+/// Only the scores added to the leaderboard since the high scores were taken
+/// from it are read. If its file is not the one they were taken from, the
+/// high scores are taken afresh from every score it holds, a page at a time.
+void Config::load_leaderboard()
+{
+    if (!take_high_scores(_scores_size))
+    {
+        _scores.clear();
+        take_high_scores(0);
     }
+    _scores_size = _leaderboard.file_size();
+}
 
-    _scores.emplace(pos, score, datetime, name);
-    while (_scores.size() > _max_high_scores)   // should happen no more than once
+///
+/// \brief Config::take_high_scores Place the scores held in the leaderboard's file after an offset among the high scores.
+/// \param offset   The length of the file when the high scores were last taken from it, or zero for every score.
+/// \return true if the leaderboard was opened to add scores after the last one read, false if its file is not the
+///         one the high scores were taken from.
+///
+bool Config::take_high_scores(std::uint64_t offset)
+{
+    while (const auto page{_leaderboard.page(offset, Leaderboard::scan_page)})
+    {
+        for (const auto &entry : page->entries)
+            place_high_score(entry.score, QDateTime::fromMSecsSinceEpoch(entry.when), QString::fromStdString(entry.name));
+        offset = page->next;
+        if (page->entries.size() < Leaderboard::scan_page)
+            break;
+    }
+
+    return _leaderboard.open(offset);
+}
+
+///
+/// \brief Config::place_high_score Place a score among the high scores, if it is one.
+/// \param score    The score.
+/// \param when     The date and time the score occurred.
+/// \param name     The name of the player that attained the score.
+/// \return true if the score is one of the high scores, false otherwise.
+///
+bool Config::place_high_score(int score, const QDateTime &when, const QString &name)
+{
+    if (!is_high_score(score))
+        return false;
+
+    // After any equal scores, which were attained first.
+    const auto  pos{std::upper_bound(_scores.begin(), _scores.end(), score,
+                                     [](int value, const HighScore &hs) { return value > hs.score; })};
+
+    _scores.emplace(pos, score, when, name);
+    if (_scores.size() > _max_high_scores)
         _scores.pop_back();
 
     return true;
 }
+
+///
+/// \brief Config::~Config  Destroy the Config object, once any saves have been written.
+///
+Config::~Config()
+{
+    wait_for_saves();
+}
+
+///
+/// \brief Config::save Store the configuration and the high scores to the file
+///
+/// The rest of the leaderboard is not stored here. Each score is appended to
+/// the leaderboard's file as it is added.
+///
+/// The configuration is captured at once and written in the background, and
+/// \c saved is emitted when the write is done. A configuration saved again
+/// before an earlier save has begun is written in its place, so a burst of
+/// saves writes the file once.
+///
+/// Nothing is saved over a configuration file that could not be read.
+void Config::save()
+{
+    if (_unreadable)
+        return;
+
+    QByteArray  settings;
+    QByteArray  scores;
+
+    {
+        QCborStreamWriter   writer{&settings};
+
+        writer.startMap(4);
+        writer.append(QLatin1String{LastUsedName});
+        writer.append(_last_used_name);
+        writer.append(QLatin1String{PlayerId});
+        writer.append(static_cast<quint64>(_player_id));
+        writer.append(QLatin1String{MaxHighScores});
+        writer.append(static_cast<quint64>(_max_high_scores));
+        writer.append(QLatin1String{ScoresSize});
+        writer.append(static_cast<quint64>(_scores_size));
+        writer.endMap();
+    }
+    {
+        QCborStreamWriter   writer{&scores};
+
+        writer.startArray(_scores.size());
+        for (const auto &score : _scores)
+        {
+            writer.startArray(3);
+            writer.append(static_cast<qint64>(score.score));
+            writer.append(score.when.toMSecsSinceEpoch());
+            writer.append(score.name);
+            writer.endArray();
+        }
+        writer.endArray();
+    }
+
+    Header          header{};
+    const Section   index[]{
+        {SectionId::Settings, static_cast<std::uint32_t>(settings.size()), sizeof(header) + 2 * sizeof(Section)},
+        {SectionId::HighScores, static_cast<std::uint32_t>(scores.size()), sizeof(header) + 2 * sizeof(Section) + static_cast<std::uint64_t>(settings.size())},
+    };
+
+    std::copy(std::begin(Magic), std::end(Magic), header.magic);
+    header.version = Version;
+    header.byte_order = ByteOrder;
+    header.section_count = static_cast<std::uint32_t>(std::size(index));
+
+    QByteArray  bytes;
+
+    bytes.reserve(static_cast<qsizetype>(sizeof(header) + sizeof(index)) + settings.size() + scores.size());
+    bytes.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    bytes.append(reinterpret_cast<const char *>(index), sizeof(index));
+    bytes.append(settings);
+    bytes.append(scores);
+
+    QMutexLocker    lock{&_save_mutex};
+
+    _pending = std::move(bytes);
+    if (_save_queued)
+        return;
+    _save_queued = true;
+    lock.unlock();
+
+    _save_pool.start([this] { write_pending(); });
+}
+
+///
+/// \brief Config::wait_for_saves   Wait until every save has been written.
+///
+void Config::wait_for_saves()
+{
+    _save_pool.waitForDone();
+}
+
+///
+/// \brief Config::write_pending    Write the newest configuration saved to the file.
+///
+/// Runs on the save thread. The result is reported through \c saved on the
+/// thread the Config object belongs to.
+void Config::write_pending()
+{
+    QByteArray  bytes;
+
+    {
+        QMutexLocker    lock{&_save_mutex};
+
+        bytes.swap(_pending);
+        _save_queued = false;
+    }
+
+    QSaveFile   file{_path};
+    const bool  ok{   file.open(QIODevice::WriteOnly)
+                   && file.write(bytes) == bytes.size()
+                   && file.commit()};
+    const QString   error{ok ? QString{} : file.errorString()};
+
+    QMetaObject::invokeMethod(this, [this, ok, error] { emit saved(ok, error); }, Qt::QueuedConnection);
+}
+
+///
+/// \brief Config::add_high_score   Record a score.
+/// \param score    The score to be recorded
+/// \param name     The name of the player that attained the score
+/// \param datetime The data and time the score occurred
+/// \return true if the score is one of the high scores, false otherwise.
+///
+/// Every score is kept in the leaderboard, whether or not it is a high
+/// score. Adding a score appends it to the leaderboard's file without
+/// reading the scores already there, and takes time linear in the number of
+/// high scores.
+bool Config::add_high_score(int score, const QString &name, QDateTime datetime/* = QDateTime::currentDateTime()*/)
+{
+    if (!_leaderboard.opened())
+        load_leaderboard();
+
+    const bool  high{place_high_score(score, datetime, name)};
+
+    _leaderboard.add(Leaderboard::Entry{score, datetime.toMSecsSinceEpoch(), name.toStdString()});
+    _scores_size = _leaderboard.file_size();
+
+    return high;
+}
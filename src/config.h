@@ -20,16 +20,45 @@
 * with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
 **************************************************************************/
 
+#include <QByteArray>
 #include <QDateTime>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
 #include <QString>
+#include <QThreadPool>
 
+#include <cstdint>
 #include <vector>
 
+#include "leaderboard.h"
+
 ///
 /// \brief Contains configuratino information including a collection of high scores.
 ///
-class Config
+/// Every score recorded is kept in a leaderboard stored in a file of its own
+/// beside the configuration file. The high scores are the best of them, and
+/// a copy of them is kept in the configuration file, with the length the
+/// leaderboard's file had when they were taken from it. The configuration
+/// loads and adds scores quickly however long the history grows: only the
+/// scores added to the leaderboard after that length are ever read to keep
+/// the high scores up to date. The rest of the history is read on demand, a
+/// page at a time, through the leaderboard.
+///
+/// The configuration file is binary. A fixed header identifies the file and
+/// its format version, and is followed by an index giving the offset and
+/// size of each section. The sections, holding the settings and the high
+/// scores, are CBOR. Files in the JSON format of earlier versions are read,
+/// and replaced by the binary format when they are next saved.
+///
+/// The configuration is saved in the background, one save at a time. Each
+/// save writes a temporary file that then replaces the configuration file,
+/// so an interrupted save leaves the old file whole.
+///
+class Config : public QObject
 {
+    Q_OBJECT
+
 public:
     ///
     /// \brief Represents a high score including the players name and when it occurred
@@ -51,12 +80,19 @@ public:
     /// \brief Construct a Config object with a string containing the location of the configuration file.
     /// \param path A reference to a QString containing the location of the configuration file.
     ///
+    /// The leaderboard is stored at the same location, with \c .scores added.
     explicit Config(const QString &path)
       : _path(path)
-    {}
+      , _leaderboard{QFile::encodeName(path + ".scores").toStdString()}
+    {
+        _save_pool.setMaxThreadCount(1);
+    }
+
+    ~Config() override;
 
     void load();
-    void save() const;
+    void save();
+    void wait_for_saves();
 
     ///
     /// \brief last_used_name   Retrieve the last name used for high score.
@@ -76,42 +112,87 @@ public:
     }
 
     ///
-    /// \brief clear_high_scores    Clear the collection of high scores.
+    /// \brief player_id    Retrieve the anonymous id of the player, used to tell players' journals apart.
+    /// \return The id, or zero if it has not been assigned yet.
+    ///
+    std::uint64_t player_id() const noexcept
+    {
+        return _player_id;
+    }
+
+    ///
+    /// \brief clear_high_scores    Clear the collection of high scores, and every other score recorded.
     ///
     void clear_high_scores()
     {
+        _leaderboard.clear();
+        _scores_size = _leaderboard.file_size();
         _scores.clear();
     }
 
     ///
     /// \brief hi_scores    Retrieve the high scores collection.
-    /// \return A const reference to a \c std::vector of \c HighScore structures.
+    /// \return A const reference to a \c std::vector of \c HighScore structures, from the highest score down.
     ///
     const std::vector<HighScore> &hi_scores() const noexcept
     {
         return _scores;
     }
 
+    ///
+    /// \brief leaderboard  Retrieve the leaderboard holding every score recorded.
+    /// \return A const reference to the leaderboard, whose \c page reads the history a page at a time.
+    ///
+    const Leaderboard &leaderboard() const noexcept
+    {
+        return _leaderboard;
+    }
+
     ///
     /// \brief is_high_score    Determine if a given score is a high score.
     /// \param score    The score value to be checked.
     /// \return true if the score is a high score, false otherwise.
     ///
-    bool is_high_score(int score)
+    bool is_high_score(int score) const noexcept
     {
-        if (_scores.empty() || _scores.size() < _max_high_scores || score > _scores.back().score)
-            return true;
+        if (_max_high_scores < 1)
+            return false;
 
-        return false;
+        return _scores.size() < _max_high_scores || score > _scores.back().score;
     }
 
     bool add_high_score(int score, const QString &name, QDateTime datetime = QDateTime::currentDateTime());
 
+signals:
+    ///
+    /// \brief Signal indicating that a save has finished.
+    /// \param ok       true if the configuration file was written, false otherwise.
+    /// \param error    A description of the failure, if it failed.
+    ///
+    void saved(bool ok, const QString &error);
+
 private:
+    bool read(QFile &file);
+    bool read_settings(const QByteArray &cbor);
+    bool read_high_scores(const QByteArray &cbor);
+    bool read_json(const QByteArray &json, std::vector<HighScore> &legacy_scores);
+    void load_leaderboard();
+    bool take_high_scores(std::uint64_t offset);
+    bool place_high_score(int score, const QDateTime &when, const QString &name);
+    void write_pending();
+
     QString                 _path;
     QString                 _last_used_name;
+    std::uint64_t           _player_id{0};
     size_t                  _max_high_scores{20};
-    std::vector<HighScore>  _scores;
+    std::vector<HighScore>  _scores;            // the best of the leaderboard's entries
+    Leaderboard             _leaderboard;
+    std::uint64_t           _scores_size{0};    // the length of the leaderboard's file when the high scores were taken from it
+    bool                    _unreadable{false}; // the file is a configuration file that could not be read, and is kept
+    QThreadPool             _save_pool;         // a single thread, so saves are written in order
+    QMutex                  _save_mutex;        // guards the two members below
+    QByteArray              _pending;           // the newest settings not yet being written
+    bool                    _save_queued{false};
 };
 
 #endif // CONFIG_H
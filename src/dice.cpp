@@ -0,0 +1,172 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include "dice.h"
+
+///
+/// \brief Dice::Dice   Construct a Dice object.
+///
+Dice::Dice()
+  : _gen{(std::uint64_t{std::random_device{}()} << 32) | std::random_device{}()}
+  , _bounces_distr{4, 20}
+{
+    _timer.setInterval(frame_interval);
+    connect(&_timer, &QTimer::timeout, this, &Dice::next_frame);
+}
+
+///
+/// \brief Dice::roll   Roll the dice, coming to rest on a given outcome.
+/// \param result   The outcome of the roll. Dice it marks as kept do not move.
+///
+/// Each die that is not kept bounces a random number of times, showing a
+/// random face on each bounce but the last, which shows its face in the
+/// outcome. The frames are worked out here and played back by a timer, so
+/// this function returns at once. The \c on_die_changed signal is emitted as
+/// each die's face changes, and \c on_roll_finished once every die is at rest.
+///
+/// When rolls are not animated the dice come to rest at once, and a single
+/// \c on_dice_changed signal is emitted in place of the per-die signals.
+///
+/// A roll still bouncing is finished first.
+void Dice::roll(const PackedDice &result)
+{
+    finish();
+
+    if (!_animated)
+    {
+        _dice = result;
+        emit on_dice_changed();
+        emit on_roll_finished();
+        return;
+    }
+
+    std::array<int, 5>  bounces{0, 0, 0, 0, 0};
+
+    for (size_t i{0}; i < _dice.size(); ++i)
+        if (!result.is_kept(i))
+            bounces[i] = _bounces_distr(_gen);
+
+    const int   frame_count{*std::max_element(bounces.begin(), bounces.end())};
+    Frame       frame{};
+
+    for (size_t i{0}; i < _dice.size(); ++i)
+        frame.faces[i] = static_cast<std::uint8_t>(_dice.face(i));
+
+    _frames.clear();
+    for (int f{0}; f < frame_count; ++f)
+    {
+        frame.changed = 0;
+        for (size_t i{0}; i < _dice.size(); ++i)
+            if (f < bounces[i])
+            {
+                frame.faces[i] = static_cast<std::uint8_t>(f + 1 < bounces[i] ? _gen.face() : result.face(i));
+                frame.changed |= static_cast<std::uint8_t>(1u << i);
+            }
+        _frames.push_back(frame);
+    }
+
+    _result = result;
+    _next_frame = 0;
+    if (_frames.empty())
+    {
+        _dice = _result;
+        emit on_roll_finished();
+    }
+    else
+    {
+        next_frame();
+        if (_next_frame < _frames.size())
+            _timer.start();
+    }
+}
+
+///
+/// \brief Dice::finish Bring the dice to rest at once.
+///
+/// Any frames of the current roll not yet shown are skipped, and the dice
+/// show the outcome of the roll. Does nothing if the dice are not rolling.
+void Dice::finish()
+{
+    if (_next_frame >= _frames.size())
+        return;
+
+    Frame   last{_frames.back()};
+
+    last.changed = 0;
+    for (size_t i{0}; i < _dice.size(); ++i)
+        if (last.faces[i] != _dice.face(i))
+            last.changed |= static_cast<std::uint8_t>(1u << i);
+
+    _next_frame = _frames.size() - 1;
+    _frames.back() = last;
+    next_frame();
+}
+
+///
+/// \brief Dice::reset  Reset the dice, abandoning any roll in progress.
+///
+void Dice::reset()
+{
+    _timer.stop();
+    _frames.clear();
+    _next_frame = 0;
+    _dice = PackedDice{};
+}
+
+///
+/// \brief Dice::show   Show a set of dice at once, abandoning any roll in progress.
+/// \param dice The dice to show.
+///
+/// A single \c on_dice_changed signal is emitted.
+void Dice::show(const PackedDice &dice)
+{
+    reset();
+    _dice = dice;
+    emit on_dice_changed();
+}
+
+///
+/// \brief Dice::next_frame Show the next frame of the bounce animation.
+///
+void Dice::next_frame()
+{
+    show_frame(_frames[_next_frame++]);
+    if (_next_frame == _frames.size())
+    {
+        _timer.stop();
+        _dice = _result;
+        emit on_roll_finished();
+    }
+}
+
+void Dice::show_frame(const Frame &frame)
+{
+    for (size_t i{0}; i < _dice.size(); ++i)
+        if (frame.changed & (1u << i))
+        {
+            _dice.face(i, frame.faces[i]);
+            emit on_die_changed(static_cast<int>(i), frame.faces[i]);
+        }
+}
@@ -21,13 +21,24 @@
 **************************************************************************/
 
 #include <QObject>
-#include <QThread>
+#include <QTimer>
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <random>
+#include <vector>
 
+#include "facegenerator.h"
+#include "packeddice.h"
+
+///
+/// \brief The Dice class presents a set of five dice.
 ///
-/// \brief The Dice class represents a set of five dice.
+/// The outcome of each roll is decided by the game engine. This class shows
+/// the dice bouncing before they come to rest on that outcome. The bounces are
+/// worked out when the roll starts and then played back by a timer, so the
+/// event loop keeps running while the dice bounce.
 ///
 class Dice : public QObject
 {
@@ -35,15 +46,11 @@ class Dice : public QObject
 
 public:
     ///
-    /// \brief Construct a Dice object.
+    /// \brief The time between frames of the bounce animation, in milliseconds.
     ///
-    Dice()
-      : _gen{std::random_device{}()}
-      , _distr{1, 6}
-      , _bounces_distr{4, 20}
-      , _dice{1, 2, 3, 4, 5}
-      , _selected{false, false, false, false, false}
-    {}
+    static constexpr int    frame_interval{40};
+
+    Dice();
 
     Dice(const Dice &) = delete;
     Dice(Dice &&) = delete;
@@ -60,74 +67,52 @@ public:
     }
 
     ///
-    /// \brief  Retrieve the collection of dice.
+    /// \brief  Retrieve the collection of dice being shown.
     /// \return A \c std::array of five integers representing the face value of each die.
     ///
-    const std::array<int, 5> &dice() const noexcept
+    std::array<int, 5> dice() const noexcept
     {
-        return _dice;
+        return _dice.faces();
     }
 
     ///
-    /// \brief  Mark a single die as selected.
-    /// \param ndx      Zero-based index of the die to select,
-    /// \param selected true to select, false to un-select.
+    /// \brief  Retrieve the compact representation of the dice being shown.
+    /// \return A reference to a \c PackedDice value.
     ///
-    void select(size_t ndx, bool selected)
+    const PackedDice &packed() const noexcept
     {
-        _selected[ndx] = selected;
+        return _dice;
     }
+
     ///
-    /// \brief Determine whether a die is selected
-    /// \param ndx  Zero-based index of the die to be checked
-    /// \return true if the die is selected, false otherwise
+    /// \brief  Determine whether the dice are still bouncing.
     ///
-    bool is_selected(size_t ndx)
+    bool is_rolling() const noexcept
     {
-        return _selected[ndx];
+        return _timer.isActive();
     }
 
     ///
-    /// \brief  Roll the dice.
+    /// \brief  Determine whether rolls are animated.
     ///
-    /// This function emits the \c on_die_changed signal as the face of each die
-    /// changes, including during simulated "bounces".
-    ///
-    void roll()
+    bool animated() const noexcept
     {
-        std::array<int, 5>  bounces{0, 0, 0, 0, 0};
-
-        for (size_t i{0}; i < _dice.size(); ++i)
-            if (!is_selected(i))
-                bounces[i] = _bounces_distr(_gen);
-
-        while (bounces[0] || bounces[1] || bounces[2] || bounces[3] || bounces[4])
-        {
-            for (size_t i{0}; i < _dice.size(); ++i)
-            {
-                if (bounces[i])
-                {
-                    --bounces[i];
-                    _dice[i] = _distr(_gen);
-                    emit on_die_changed(i, _dice[i]);
-                    QThread::msleep(20);
-                }
-            }
-        }
+        return _animated;
     }
-
     ///
-    /// \brief  Reset the dice.
+    /// \brief  Set whether rolls are animated.
+    /// \param animated false to have the dice come to rest at once, as in turbo mode.
     ///
-    void reset()
+    void animated(bool animated) noexcept
     {
-        for (size_t i{0}; i < _dice.size(); ++i)
-        {
-            _dice[i] = i + 1;
-            _selected[i] = false;
-        }
+        _animated = animated;
     }
 
+    void roll(const PackedDice &result);
+    void finish();
+    void reset();
+    void show(const PackedDice &dice);
+
 signals:
     ///
     /// \brief  Signal indicating that a die's face has changed.
@@ -136,12 +121,41 @@ signals:
     ///
     void on_die_changed(int index, int value);
 
+    ///
+    /// \brief  Signal indicating that any or all of the dice have changed at once.
+    ///
+    /// This is emitted in place of \c on_die_changed when rolls are not animated.
+    ///
+    void on_dice_changed();
+
+    ///
+    /// \brief  Signal indicating that the dice have come to rest on the outcome of a roll.
+    ///
+    void on_roll_finished();
+
+private slots:
+    void next_frame();
+
 private:
-    std::mt19937        _gen;
-    std::uniform_int_distribution<> _distr;
+    ///
+    /// \brief One step of the bounce animation.
+    ///
+    struct Frame
+    {
+        std::array<std::uint8_t, 5> faces;
+        std::uint8_t                changed;    // bit n is set when die n moves in this frame
+    };
+
+    void show_frame(const Frame &frame);
+
+    FaceGenerator                   _gen;
     std::uniform_int_distribution<> _bounces_distr;
-    std::array<int, 5>  _dice;
-    std::array<bool, 5> _selected;
+    PackedDice                      _dice;      // the dice as shown
+    PackedDice                      _result;    // the dice the current roll comes to rest on
+    std::vector<Frame>              _frames;
+    size_t                          _next_frame{0};
+    QTimer                          _timer;
+    bool                            _animated{true};
 };
 
 #endif // DICE_H
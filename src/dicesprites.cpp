@@ -0,0 +1,84 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <QRect>
+#include <QString>
+
+#include <algorithm>
+
+#include "dicesprites.h"
+
+///
+/// \brief DiceSprites::face    Retrieve the image of a die face for a device pixel ratio.
+/// \param value                The face value, from 1 to 6.
+/// \param device_pixel_ratio   The device pixel ratio of the screen the face is shown on.
+/// \return The pixmap, which has the given device pixel ratio.
+///
+/// Faces for ratios of one or two are cut straight from the atlas; other
+/// ratios are scaled once from the atlas with the next larger scale.
+QPixmap DiceSprites::face(int value, qreal device_pixel_ratio)
+{
+    for (const auto &faces : _faces)
+        if (qFuzzyCompare(faces.ratio, device_pixel_ratio))
+            return faces.pixmaps[value - 1];
+
+    const int       scale{device_pixel_ratio > 1.0 ? 2 : 1};
+    const QPixmap   atlas{scale == 1 ? QString{":/dice.png"} : QString{":/dice@2x.png"}};
+    const int       source_size{face_size * scale};
+    const int       target_size{qRound(face_size * device_pixel_ratio)};
+    Faces           faces{device_pixel_ratio, {}};
+
+    for (int f{0}; f < 6; ++f)
+    {
+        QPixmap pixmap{atlas.copy(QRect{f * source_size, 0, source_size, source_size})};
+
+        if (target_size != source_size)
+            pixmap = pixmap.scaled(target_size, target_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        pixmap.setDevicePixelRatio(device_pixel_ratio);
+        faces.pixmaps[f] = pixmap;
+    }
+
+    _faces.push_back(faces);
+    return _faces.back().pixmaps[value - 1];
+}
+
+///
+/// \brief DiceSprites::icon    Retrieve an icon of a die face.
+/// \param value                The face value, from 1 to 6.
+/// \param device_pixel_ratio   The device pixel ratio of the screen the icon is shown on.
+/// \return The icon, which holds the face at one and two device pixels per
+///         pixel and at the given ratio, so that it stays sharp on any screen.
+///
+QIcon DiceSprites::icon(int value, qreal device_pixel_ratio)
+{
+    for (const qreal ratio : {1.0, 2.0, device_pixel_ratio})
+    {
+        const auto  added{std::find_if(_icon_ratios.begin(), _icon_ratios.end(),
+                                       [ratio](qreal r) { return qFuzzyCompare(r, ratio); })};
+
+        if (added == _icon_ratios.end())
+        {
+            for (int f{0}; f < 6; ++f)
+                _icons[f].addPixmap(face(f + 1, ratio));
+            _icon_ratios.push_back(ratio);
+        }
+    }
+
+    return _icons[value - 1];
+}
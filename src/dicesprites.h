@@ -0,0 +1,73 @@
+#ifndef DICESPRITES_H
+#define DICESPRITES_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <QIcon>
+#include <QPixmap>
+#include <QSize>
+
+#include <array>
+#include <vector>
+
+///
+/// \brief Supplies the images of the six die faces.
+///
+/// The faces come from a prebuilt atlas in the Qt resource system, drawn at
+/// one and two device pixels per pixel. The pixmaps for each device pixel
+/// ratio are cut from the atlas nearest in scale the first time they are
+/// asked for, and shared from then on. Pixmaps are implicitly shared, so they
+/// are handed out by value.
+///
+class DiceSprites
+{
+public:
+    ///
+    /// \brief The size of a die face in device-independent pixels.
+    ///
+    static constexpr int    face_size{64};
+
+    ///
+    /// \brief  Retrieve the size of a die face.
+    ///
+    static QSize size() noexcept
+    {
+        return QSize{face_size, face_size};
+    }
+
+    QPixmap face(int value, qreal device_pixel_ratio);
+    QIcon icon(int value, qreal device_pixel_ratio);
+
+private:
+    ///
+    /// \brief The faces drawn at one device pixel ratio.
+    ///
+    struct Faces
+    {
+        qreal                   ratio;
+        std::array<QPixmap, 6>  pixmaps;
+    };
+
+    std::vector<Faces>      _faces;
+    std::array<QIcon, 6>    _icons;
+    std::vector<qreal>      _icon_ratios;   // the device pixel ratios the icons hold faces for
+};
+
+#endif // DICESPRITES_H
@@ -0,0 +1,219 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include "facegenerator.h"
+
+namespace {
+///
+/// \brief The number of equally likely sets of 24 faces, 6^24.
+///
+constexpr std::uint64_t face_sets{4738381338321616896u};
+
+///
+/// \brief Draws below this are accepted; it is the largest multiple of 6^24 below 2^64.
+///
+constexpr std::uint64_t accept_limit{3 * face_sets};
+
+static_assert(accept_limit / 3 == face_sets && accept_limit > face_sets, "6^24 multiple overflowed");
+}   // anonymous namespace
+
+///
+/// \brief FaceGenerator::FaceGenerator Construct a FaceGenerator.
+/// \param seed     The seed for the generator.
+/// \param engine   The pseudo-random generator to use.
+///
+FaceGenerator::FaceGenerator(std::uint64_t seed, Engine engine)
+{
+    this->seed(seed, 0, engine);
+}
+
+///
+/// \brief FaceGenerator::seed  Restart the generator.
+/// \param seed     The seed for the generator.
+/// \param stream   The stream to take from the seed.
+/// \param engine   The pseudo-random generator to use.
+///
+/// Faces generated but not yet used are discarded, so the faces that follow
+/// depend only on the seed, the stream and the engine.
+void FaceGenerator::seed(std::uint64_t seed, std::uint64_t stream, Engine engine)
+{
+    const std::uint64_t stream_seed{SplitMix64{seed + stream * 0x9E3779B97F4A7C15u}()};
+
+    switch (engine)
+    {
+    case Engine::Xoshiro256:
+        _gen.emplace<Xoshiro256StarStar>(stream_seed);
+        break;
+    case Engine::Pcg32:
+        _gen.emplace<Pcg32>(seed, stream);
+        break;
+    case Engine::Mt19937:
+        _gen.emplace<std::mt19937_64>(stream_seed);
+        break;
+    case Engine::Philox:
+        _gen.emplace<Philox4x32>(seed, stream);
+        break;
+    }
+    _pool = 0;
+    _faces_left = 0;
+}
+
+///
+/// \brief FaceGenerator::engine_from_name  Find a pseudo-random generator by its short name.
+/// \param name One of "xoshiro", "pcg", "mt" or "philox".
+/// \return The generator, or an empty \c std::optional if the name is not known.
+///
+std::optional<FaceGenerator::Engine> FaceGenerator::engine_from_name(std::string_view name) noexcept
+{
+    for (const auto engine : {Engine::Xoshiro256, Engine::Pcg32, Engine::Mt19937, Engine::Philox})
+        if (name == engine_name(engine))
+            return engine;
+
+    return std::nullopt;
+}
+
+///
+/// \brief FaceGenerator::engine_name   Retrieve the short name of a pseudo-random generator.
+/// \param engine   The generator.
+///
+const char *FaceGenerator::engine_name(Engine engine) noexcept
+{
+    switch (engine)
+    {
+    case Engine::Xoshiro256:
+        return "xoshiro";
+    case Engine::Pcg32:
+        return "pcg";
+    case Engine::Mt19937:
+        return "mt";
+    case Engine::Philox:
+        return "philox";
+    }
+
+    return "";
+}
+
+///
+/// \brief FaceGenerator::faces Generate the faces of many dice.
+/// \param out      Receives the faces, each from 1 to 6.
+/// \param count    The number of faces to generate.
+///
+void FaceGenerator::faces(std::uint8_t *out, size_t count) noexcept
+{
+    for (size_t i{0}; i < count; ++i)
+        out[i] = static_cast<std::uint8_t>(face());
+}
+
+///
+/// \brief FaceGenerator::skip  Skip over faces, as if they had been generated.
+/// \param count    The number of faces to skip.
+///
+void FaceGenerator::skip(size_t count) noexcept
+{
+    while (count > 0)
+    {
+        if (_faces_left == 0)
+            refill();
+
+        const int   n{static_cast<int>(std::min<size_t>(count, static_cast<size_t>(_faces_left)))};
+
+        for (int i{0}; i < n; ++i)
+            _pool /= 6;
+        _faces_left -= n;
+        count -= static_cast<size_t>(n);
+    }
+}
+
+///
+/// \brief FaceGenerator::position  Take the generator's position in its stream of faces.
+/// \return The position, which \c seek() returns to.
+///
+FaceGenerator::Position FaceGenerator::position() const noexcept
+{
+    Position    position{{}, _pool, _faces_left};
+
+    std::visit([&position](const auto &gen)
+               {
+                   if constexpr (!std::is_same_v<std::decay_t<decltype(gen)>, std::mt19937_64>)
+                       position.gen = gen;
+               },
+               _gen);
+
+    return position;
+}
+
+///
+/// \brief FaceGenerator::seek  Return the generator to a position taken by \c position().
+/// \param position The position.
+/// \return true if the generator was returned to the position, false if the
+///         position holds no generator of this generator's engine.
+///
+bool FaceGenerator::seek(const Position &position) noexcept
+{
+    const bool  found{std::visit([this](const auto &gen)
+                                 {
+                                     using Gen = std::decay_t<decltype(gen)>;
+
+                                     if constexpr (std::is_same_v<Gen, std::monostate>)
+                                     {
+                                         return false;
+                                     }
+                                     else
+                                     {
+                                         if (!std::holds_alternative<Gen>(_gen))
+                                             return false;
+                                         _gen = gen;
+                                         return true;
+                                     }
+                                 },
+                                 position.gen)};
+
+    if (found)
+    {
+        _pool = position.pool;
+        _faces_left = position.faces_left;
+    }
+
+    return found;
+}
+
+///
+/// \brief FaceGenerator::refill    Draw another 24 faces.
+///
+void FaceGenerator::refill() noexcept
+{
+    std::uint64_t   x;
+
+    do
+    {
+        x = (*this)();
+    } while (x >= accept_limit);
+
+    _pool = x;
+    _faces_left = faces_per_draw;
+}
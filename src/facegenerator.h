@@ -0,0 +1,328 @@
+#ifndef FACEGENERATOR_H
+#define FACEGENERATOR_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <variant>
+
+///
+/// \brief The SplitMix64 generator, used mainly to seed the others.
+///
+class SplitMix64
+{
+public:
+    using result_type = std::uint64_t;
+
+    explicit constexpr SplitMix64(std::uint64_t seed = 0) noexcept
+      : _state{seed}
+    {}
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept
+    {
+        std::uint64_t   z{_state += 0x9E3779B97F4A7C15u};
+
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+        return z ^ (z >> 31);
+    }
+
+private:
+    std::uint64_t   _state;
+};
+
+///
+/// \brief The xoshiro256** generator by Blackman and Vigna.
+///
+class Xoshiro256StarStar
+{
+public:
+    using result_type = std::uint64_t;
+
+    explicit constexpr Xoshiro256StarStar(std::uint64_t seed = 0) noexcept
+    {
+        SplitMix64  init{seed};
+
+        for (auto &s : _s)
+            s = init();
+    }
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept
+    {
+        const std::uint64_t result{rotl(_s[1] * 5, 7) * 9};
+        const std::uint64_t t{_s[1] << 17};
+
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = rotl(_s[3], 45);
+
+        return result;
+    }
+
+private:
+    static constexpr std::uint64_t rotl(std::uint64_t x, int k) noexcept
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::uint64_t   _s[4]{};
+};
+
+///
+/// \brief The PCG32 generator (XSH RR 64/32) by O'Neill.
+///
+class Pcg32
+{
+public:
+    using result_type = std::uint32_t;
+
+    explicit constexpr Pcg32(std::uint64_t seed = 0, std::uint64_t stream = 0) noexcept
+      : _inc{(stream << 1) | 1u}
+    {
+        (*this)();
+        _state += seed;
+        (*this)();
+    }
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept
+    {
+        const std::uint64_t old{_state};
+
+        _state = old * 6364136223846793005u + _inc;
+
+        const auto  xorshifted{static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27)};
+        const auto  rot{static_cast<std::uint32_t>(old >> 59)};
+
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+private:
+    std::uint64_t   _state{0};
+    std::uint64_t   _inc;
+};
+
+///
+/// \brief The Philox4x32-10 counter-based generator by Salmon et al.
+///
+/// Each output is a pure function of the key, the stream and the position in
+/// the stream, so any number of independent streams can be derived from one
+/// key without coordination, and any stream can be reproduced on its own.
+///
+class Philox4x32
+{
+public:
+    using result_type = std::uint64_t;
+
+    explicit constexpr Philox4x32(std::uint64_t key = 0, std::uint64_t stream = 0) noexcept
+      : _key{static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32)}
+      , _stream{stream}
+    {}
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept
+    {
+        if (_used == 2)
+        {
+            block();
+            _used = 0;
+        }
+
+        return _out[_used++];
+    }
+
+private:
+    ///
+    /// \brief  Encrypt the next counter, yielding two outputs.
+    ///
+    constexpr void block() noexcept
+    {
+        std::uint32_t   ctr[4]{static_cast<std::uint32_t>(_counter), static_cast<std::uint32_t>(_counter >> 32),
+                               static_cast<std::uint32_t>(_stream), static_cast<std::uint32_t>(_stream >> 32)};
+        std::uint32_t   key[2]{_key[0], _key[1]};
+
+        for (int round{0}; round < 10; ++round)
+        {
+            const std::uint64_t p0{std::uint64_t{0xD2511F53u} * ctr[0]};
+            const std::uint64_t p1{std::uint64_t{0xCD9E8D57u} * ctr[2]};
+
+            ctr[0] = static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0];
+            ctr[1] = static_cast<std::uint32_t>(p1);
+            ctr[2] = static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1];
+            ctr[3] = static_cast<std::uint32_t>(p0);
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+        }
+
+        _out[0] = (std::uint64_t{ctr[1]} << 32) | ctr[0];
+        _out[1] = (std::uint64_t{ctr[3]} << 32) | ctr[2];
+        ++_counter;
+    }
+
+    std::uint32_t   _key[2];
+    std::uint64_t   _stream;
+    std::uint64_t   _counter{0};
+    std::uint64_t   _out[2]{};
+    int             _used{2};
+};
+
+///
+/// \brief Generates die faces from a choice of pseudo-random generators.
+///
+/// Each 64-bit draw from the generator yields 24 unbiased faces: draws of
+/// 3 * 6^24 or more are rejected, and an accepted draw is split into its 24
+/// lowest base-6 digits. About 77% of draws are accepted, so a face costs
+/// well under a tenth of a draw on average. Generators producing 32 bits are
+/// called twice per draw.
+///
+/// A generator is seeded with a seed and a stream number, and the faces it
+/// produces depend on nothing else. Philox uses the stream as the high half of
+/// its counter; the other generators are seeded from the stream-th output of
+/// SplitMix64 started at the seed, except PCG32, which has streams of its own.
+///
+/// A FaceGenerator is also a uniform random bit generator, producing 64-bit
+/// draws, for uses other than die faces.
+///
+class FaceGenerator
+{
+public:
+    ///
+    /// \brief The pseudo-random generators available.
+    ///
+    enum class Engine
+    {
+        Xoshiro256,
+        Pcg32,
+        Mt19937,
+        Philox,
+    };
+
+    using result_type = std::uint64_t;
+
+    ///
+    /// \brief The state of a generator at some point in its stream of faces.
+    ///
+    /// The Mersenne Twister's state is several KB, so a position taken from
+    /// it holds no generator; it can only be returned to by restarting the
+    /// generator and skipping faces.
+    ///
+    struct Position
+    {
+        std::variant<std::monostate, Xoshiro256StarStar, Pcg32, Philox4x32> gen;
+        std::uint64_t   pool{0};
+        int             faces_left{0};
+    };
+
+    static constexpr int    faces_per_draw{24};
+
+    explicit FaceGenerator(std::uint64_t seed = 0, Engine engine = Engine::Xoshiro256);
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    static std::optional<Engine> engine_from_name(std::string_view name) noexcept;
+    static const char *engine_name(Engine engine) noexcept;
+
+    void seed(std::uint64_t seed, std::uint64_t stream, Engine engine);
+
+    ///
+    /// \brief  Restart the generator, keeping the same engine.
+    /// \param seed     The seed for the generator.
+    /// \param stream   The stream to take from the seed.
+    ///
+    void seed(std::uint64_t seed, std::uint64_t stream = 0)
+    {
+        this->seed(seed, stream, engine());
+    }
+
+    Engine engine() const noexcept
+    {
+        return static_cast<Engine>(_gen.index());
+    }
+
+    result_type operator()() noexcept
+    {
+        return std::visit([](auto &gen) { return draw(gen); }, _gen);
+    }
+
+    ///
+    /// \brief  Generate the face of one die.
+    /// \return A value from 1 to 6.
+    ///
+    int face() noexcept
+    {
+        if (_faces_left == 0)
+            refill();
+        --_faces_left;
+
+        const int   value{static_cast<int>(_pool % 6)};
+
+        _pool /= 6;
+        return value + 1;
+    }
+
+    void faces(std::uint8_t *out, size_t count) noexcept;
+    void skip(size_t count) noexcept;
+
+    Position position() const noexcept;
+    bool seek(const Position &position) noexcept;
+
+private:
+    template<typename Gen>
+    static std::uint64_t draw(Gen &gen) noexcept
+    {
+        if constexpr (Gen::max() == std::numeric_limits<std::uint64_t>::max())
+        {
+            return gen();
+        }
+        else
+        {
+            const std::uint64_t high{gen()};
+
+            return (high << 32) | gen();
+        }
+    }
+
+    void refill() noexcept;
+
+    std::variant<Xoshiro256StarStar, Pcg32, std::mt19937_64, Philox4x32>    _gen;   // alternatives in Engine order
+    std::uint64_t   _pool{0};           // faces not yet used, as base-6 digits
+    int             _faces_left{0};
+};
+
+#endif // FACEGENERATOR_H
@@ -0,0 +1,285 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gameengine.h"
+
+///
+/// \brief GameEngine::new_game Begin the game following the current one under the same master seed.
+///
+void GameEngine::new_game()
+{
+    new_game(_seed, _game_id + 1);
+}
+
+///
+/// \brief GameEngine::new_game Clear the score sheet and the dice to begin a particular game.
+/// \param seed     The master seed.
+/// \param game_id  The id of the game under the master seed.
+///
+/// The dice are rolled from a stream determined only by the master seed, the
+/// game id and the engine, so a game played with the same choices always
+/// sees the same dice, whichever games were played before it.
+void GameEngine::new_game(std::uint64_t seed, std::uint64_t game_id)
+{
+    _seed = seed;
+    _game_id = game_id;
+    _faces.seed(seed, game_id);
+    _drawn = 0;
+    _sheet.clear();
+    _dice = PackedDice{};
+    _rolls_left = max_rolls;
+    _plays_left = max_plays;
+    _history.clear();
+    _refills.clear();
+    _position = 0;
+}
+
+///
+/// \brief GameEngine::roll Roll all dice that are not kept.
+/// \return A reference to the rolled dice.
+///
+/// Rolling when \c can_roll() returns false leaves the dice unchanged.
+const PackedDice &GameEngine::roll()
+{
+    if (can_roll())
+        play(Step::Action::Roll, 0);
+
+    return _dice;
+}
+
+///
+/// \brief GameEngine::keep Mark a single die as kept for the next roll.
+/// \param ndx  Zero-based index of the die.
+/// \param kept true to keep the die, false to release it.
+/// \return true if the die was changed, false if dice may not be kept now.
+///
+/// Dice may only be kept after the first roll of a turn.
+bool GameEngine::keep(size_t ndx, bool kept)
+{
+    if (ndx >= _dice.size())
+        return false;
+
+    const std::uint8_t  bit{static_cast<std::uint8_t>(1u << ndx)};
+
+    return keep_mask(kept ? _dice.keep_mask() | bit : _dice.keep_mask() & ~bit);
+}
+
+///
+/// \brief GameEngine::keep_mask    Set which dice are kept for the next roll.
+/// \param mask The mask of kept dice. Bit \c n is set when die \c n is kept.
+/// \return true if the dice were changed, false if dice may not be kept now.
+///
+/// Changes to the kept dice between one roll and the next are recorded as a
+/// single step, so they are undone together.
+bool GameEngine::keep_mask(std::uint8_t mask)
+{
+    if (!has_rolled())
+        return false;
+
+    mask &= 0x1F;
+    if (mask == _dice.keep_mask())
+        return true;
+
+    if (_position > 0 && _history[_position - 1].action == Step::Action::Keep)
+    {
+        _history.resize(_position);
+        if (mask == _history.back().keep_mask)
+        {
+            _history.pop_back();
+            --_position;
+        }
+        else
+        {
+            _history.back().argument = mask;
+        }
+        _dice.keep_mask(mask);
+        return true;
+    }
+
+    play(Step::Action::Keep, mask);
+    return true;
+}
+
+///
+/// \brief GameEngine::can_score    Determine whether the current dice may be scored in a cell.
+/// \param column   Zero-based index of the column.
+/// \param category The category within the column.
+/// \return true if the dice have been rolled this turn and the cell is open.
+///
+bool GameEngine::can_score(size_t column, Category category) const noexcept
+{
+    return    has_rolled()
+           && !game_over()
+           && column < column_count
+           && !_sheet.is_filled(column, category);
+}
+
+///
+/// \brief GameEngine::score    Score the current dice in a cell and end the turn.
+/// \param column   Zero-based index of the column.
+/// \param category The category within the column.
+/// \return true if the dice were scored, false if the cell may not be scored.
+///
+bool GameEngine::score(size_t column, Category category)
+{
+    if (!can_score(column, category))
+        return false;
+
+    play(Step::Action::Score, static_cast<std::uint8_t>(column * category_count + static_cast<size_t>(category)));
+    return true;
+}
+
+///
+/// \brief GameEngine::undo Take back the most recent step of the game.
+/// \return true if a step was taken back, false if there is none.
+///
+/// The turn resumes with the dice, kept dice and rolls left as they were
+/// before the step.
+bool GameEngine::undo()
+{
+    if (!can_undo())
+        return false;
+
+    const Step &step{_history[--_position]};
+
+    if (step.action == Step::Action::Score)
+    {
+        _sheet.clear(step.argument / category_count, static_cast<Category>(step.argument % category_count));
+        ++_plays_left;
+    }
+    restore(step);
+
+    return true;
+}
+
+///
+/// \brief GameEngine::redo Repeat the most recently undone step of the game.
+/// \return true if a step was repeated, false if there is none.
+///
+bool GameEngine::redo()
+{
+    if (!can_redo())
+        return false;
+
+    const Step &step{_history[_position++]};
+
+    restore(step);
+    perform(step);
+
+    return true;
+}
+
+///
+/// \brief GameEngine::play Record a step in the history and perform it.
+/// \param action   The action of the step.
+/// \param argument The action's argument.
+///
+/// Any undone steps are forgotten.
+void GameEngine::play(Step::Action action, std::uint8_t argument)
+{
+    _history.resize(_position);
+    _history.push_back(Step{action,
+                            argument,
+                            _dice.keep_mask(),
+                            static_cast<std::int8_t>(_rolls_left),
+                            _dice.encoding(),
+                            _drawn});
+    ++_position;
+    perform(_history.back());
+}
+
+///
+/// \brief GameEngine::perform  Perform the action of a step.
+/// \param step The step. The game must be in the state recorded by the step.
+///
+void GameEngine::perform(const Step &step)
+{
+    switch (step.action)
+    {
+    case Step::Action::Roll:
+        for (size_t i{0}; i < _dice.size(); ++i)
+            if (!_dice.is_kept(i))
+            {
+                if (_drawn % FaceGenerator::faces_per_draw == 0 && _drawn / static_cast<size_t>(FaceGenerator::faces_per_draw) == _refills.size())
+                    _refills.push_back(_faces.position());
+                _dice.face(i, _faces.face());
+                ++_drawn;
+            }
+        --_rolls_left;
+        break;
+
+    case Step::Action::Keep:
+        _dice.keep_mask(step.argument);
+        break;
+
+    case Step::Action::Score:
+    {
+        const auto  category{static_cast<Category>(step.argument % category_count)};
+
+        _sheet.set(step.argument / category_count, category, score_for(category));
+        --_plays_left;
+        _rolls_left = max_rolls;
+        _dice.keep_mask(0);
+        break;
+    }
+    }
+}
+
+///
+/// \brief GameEngine::restore  Return the turn to the state recorded by a step.
+/// \param step The step.
+///
+/// If faces have been drawn since the step, the generator is returned to
+/// where it was before the step, so the same dice are rolled next.
+void GameEngine::restore(const Step &step)
+{
+    _dice = PackedDice{step.faces, step.keep_mask};
+    _rolls_left = step.rolls_left;
+    if (_drawn != step.drawn)
+        seek(step.drawn);
+}
+
+///
+/// \brief GameEngine::seek     Return the generator to where a number of faces had been drawn from it.
+/// \param drawn    The number of faces.
+///
+/// The generator draws faces in blocks of \c FaceGenerator::faces_per_draw,
+/// and its position before each block is kept the first time the block is
+/// drawn. Seeking takes the position before the block holding the next face
+/// and skips the faces of the block already drawn, in constant time. Where
+/// that position is not known, the generator is restarted and every face
+/// drawn is skipped.
+void GameEngine::seek(std::uint16_t drawn)
+{
+    const size_t    block{drawn / static_cast<size_t>(FaceGenerator::faces_per_draw)};
+
+    if (block < _refills.size() && _faces.seek(_refills[block]))
+    {
+        _faces.skip(drawn % FaceGenerator::faces_per_draw);
+    }
+    else
+    {
+        _faces.seed(_seed, _game_id);
+        _faces.skip(drawn);
+    }
+    _drawn = drawn;
+}
@@ -0,0 +1,273 @@
+#ifndef GAMEENGINE_H
+#define GAMEENGINE_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "facegenerator.h"
+#include "gamescorer.h"
+#include "packeddice.h"
+#include "scoresheet.h"
+
+///
+/// \brief Headless engine for a game of Triple Yahtzee.
+///
+/// The engine holds the dice and the kept dice, a score sheet of three columns
+/// of thirteen categories each, and the state of the turn. It enforces the
+/// rules of play: up to three rolls per turn, one score per turn, and 39 turns
+/// per game. It has no dependency on Qt so that games can be played at full
+/// speed by simulators and other tools.
+///
+/// Each game is identified by a master seed and a game id, which together
+/// determine the dice it is rolled with, so any game can be replayed.
+///
+/// Every roll, change of kept dice and score is recorded, so the whole game
+/// can be undone and redone a step at a time. Each step is recorded in eight
+/// bytes, holding the action and the state of the turn before it; a step is
+/// redone by acting again from that state. Undoing a roll rewinds the dice's
+/// generator, so rolling again gives the same dice.
+///
+class GameEngine
+{
+public:
+    static constexpr int    max_rolls{3};
+    static constexpr int    max_plays{39};
+    static constexpr size_t column_count{ScoreSheet::column_count};
+    static constexpr int    upper_bonus_threshold{ScoreSheet::upper_bonus_threshold};
+    static constexpr int    upper_bonus{ScoreSheet::upper_bonus};
+
+    ///
+    /// \brief  Construct a GameEngine object seeded from a random device.
+    ///
+    GameEngine()
+      : GameEngine((std::uint64_t{std::random_device{}()} << 32) | std::random_device{}())
+    {}
+    ///
+    /// \brief  Construct a GameEngine object with a specific master seed, starting game zero.
+    /// \param seed     The master seed for the dice's random number generator.
+    /// \param engine   The pseudo-random generator to roll the dice with.
+    ///
+    explicit GameEngine(std::uint64_t seed, FaceGenerator::Engine engine = FaceGenerator::Engine::Xoshiro256)
+      : _faces{seed, engine}
+    {
+        new_game(seed, 0);
+    }
+
+    void new_game();
+    void new_game(std::uint64_t seed, std::uint64_t game_id);
+
+    ///
+    /// \brief  Retrieve the master seed of the current game.
+    ///
+    std::uint64_t seed() const noexcept
+    {
+        return _seed;
+    }
+    ///
+    /// \brief  Retrieve the id of the current game under its master seed.
+    ///
+    std::uint64_t game_id() const noexcept
+    {
+        return _game_id;
+    }
+    ///
+    /// \brief  Retrieve the pseudo-random generator the dice are rolled with.
+    ///
+    FaceGenerator::Engine engine() const noexcept
+    {
+        return _faces.engine();
+    }
+
+    ///
+    /// \brief  Retrieve the dice, including which dice are kept.
+    ///
+    const PackedDice &dice() const noexcept
+    {
+        return _dice;
+    }
+
+    ///
+    /// \brief  Retrieve the number of rolls left in the current turn.
+    ///
+    int rolls_left() const noexcept
+    {
+        return _rolls_left;
+    }
+    ///
+    /// \brief  Retrieve the number of turns left in the game.
+    ///
+    int plays_left() const noexcept
+    {
+        return _plays_left;
+    }
+    ///
+    /// \brief  Determine whether the dice have been rolled in the current turn.
+    ///
+    bool has_rolled() const noexcept
+    {
+        return _rolls_left < max_rolls;
+    }
+    ///
+    /// \brief  Determine whether every turn of the game has been played.
+    ///
+    bool game_over() const noexcept
+    {
+        return _plays_left == 0;
+    }
+    ///
+    /// \brief  Determine whether the dice may be rolled.
+    ///
+    bool can_roll() const noexcept
+    {
+        return _rolls_left > 0 && !game_over();
+    }
+
+    const PackedDice &roll();
+    bool keep(size_t ndx, bool kept);
+    bool keep_mask(std::uint8_t mask);
+
+    ///
+    /// \brief  Calculate the score the current dice would earn in a category.
+    /// \param category The category to be scored.
+    ///
+    int score_for(Category category) const noexcept
+    {
+        return GameScorer{_dice}.score(category);
+    }
+
+    bool can_score(size_t column, Category category) const noexcept;
+    bool score(size_t column, Category category);
+    ///
+    /// \brief  Determine whether there is a step to undo.
+    ///
+    bool can_undo() const noexcept
+    {
+        return _position > 0;
+    }
+    ///
+    /// \brief  Determine whether there is an undone step to redo.
+    ///
+    bool can_redo() const noexcept
+    {
+        return _position < _history.size();
+    }
+    ///
+    /// \brief  Retrieve the number of steps of the game's history that have not been undone.
+    ///
+    size_t steps_taken() const noexcept
+    {
+        return _position;
+    }
+    bool undo();
+    bool redo();
+
+    ///
+    /// \brief  Retrieve the score sheet.
+    ///
+    const ScoreSheet &sheet() const noexcept
+    {
+        return _sheet;
+    }
+    ///
+    /// \brief  Retrieve the score in a single cell of the score sheet.
+    /// \param column   Zero-based index of the column.
+    /// \param category The category within the column.
+    /// \return The score, or an empty \c std::optional if the cell has not been scored.
+    ///
+    std::optional<int> cell(size_t column, Category category) const noexcept
+    {
+        return _sheet.cell(column, category);
+    }
+
+    ///
+    /// \brief  Retrieve the multiplier applied to a column's combined total.
+    /// \param column   Zero-based index of the column.
+    ///
+    static constexpr int multiplier(size_t column) noexcept
+    {
+        return ScoreSheet::multiplier(column);
+    }
+
+    ///
+    /// \brief  Retrieve the totals of a score column.
+    /// \param column   Zero-based index of the column.
+    ///
+    ColumnTotals column_totals(size_t column) const noexcept
+    {
+        return _sheet.totals(column);
+    }
+    ///
+    /// \brief  Retrieve the sum of all three columns' totals.
+    ///
+    int grand_total() const noexcept
+    {
+        return _sheet.grand_total();
+    }
+
+private:
+    friend class SavedGame;
+
+    ///
+    /// \brief One step of the game's history.
+    ///
+    struct Step
+    {
+        enum class Action : std::uint8_t
+        {
+            Roll,
+            Keep,
+            Score,
+        };
+
+        Action          action;
+        std::uint8_t    argument;       // the kept dice after a Keep, the cell scored by a Score
+        std::uint8_t    keep_mask;      // the state of the turn before the step
+        std::int8_t     rolls_left;
+        std::uint16_t   faces;          // encoding of the dice
+        std::uint16_t   drawn;          // number of faces drawn from the generator
+    };
+
+    static_assert(sizeof(Step) == 8);
+
+    void play(Step::Action action, std::uint8_t argument);
+    void perform(const Step &step);
+    void restore(const Step &step);
+    void seek(std::uint16_t drawn);
+
+    FaceGenerator                   _faces;
+    std::uint64_t                   _seed{0};
+    std::uint64_t                   _game_id{0};
+    PackedDice                      _dice;
+    ScoreSheet                      _sheet;
+    int                             _rolls_left{max_rolls};
+    int                             _plays_left{max_plays};
+    std::uint16_t                   _drawn{0};
+    std::vector<Step>               _history;
+    std::vector<FaceGenerator::Position>    _refills;       // the generator's position before each block of faces drawn
+    size_t                          _position{0};   // the number of steps not undone
+};
+
+#endif // GAMEENGINE_H
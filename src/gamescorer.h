@@ -21,8 +21,34 @@
 **************************************************************************/
 
 #include <array>
+#include <cstddef>
 
-#include "dice.h"
+#include "packeddice.h"
+
+///
+/// \brief Identifies one of the thirteen scoring categories in a score column.
+///
+enum class Category : int
+{
+    Aces,
+    Twos,
+    Threes,
+    Fours,
+    Fives,
+    Sixes,
+    ThreeOfAKind,
+    FourOfAKind,
+    FullHouse,
+    SmallStraight,
+    LargeStraight,
+    Yahtzee,
+    Chance
+};
+
+///
+/// \brief The number of scoring categories in a score column.
+///
+constexpr size_t category_count{13};
 
 ///
 /// \brief Engine for calculateing Yahtzee scores based on rolled dice.
@@ -31,41 +57,46 @@ class GameScorer
 {
 public:
     ///
-    /// \brief  Construct a GameScorer object from a Dice object.
-    /// \param dice Reference to a Dice object containing rolled dice.
+    /// \brief  Construct a GameScorer object from a set of dice.
+    /// \param dice Reference to a PackedDice object containing rolled dice.
     ///
-    GameScorer(const Dice &dice)
-      : _pip_counts{0, 0, 0, 0, 0, 0}
-    {
-        for (const auto die : dice.dice())
-            ++_pip_counts[die - 1];
-    }
+    constexpr GameScorer(const PackedDice &dice)
+      : _pip_counts{dice.pip_counts()}
+    {}
 
-    int aces() const noexcept
+    ///
+    /// \brief  Construct a GameScorer object from the number of dice showing each face.
+    /// \param pip_counts   The number of dice showing one through six pips.
+    ///
+    explicit constexpr GameScorer(const std::array<int, 6> &pip_counts)
+      : _pip_counts{pip_counts}
+    {}
+
+    constexpr int aces() const noexcept
     {
         return _pip_counts[0];
     }
-    int twos() const noexcept
+    constexpr int twos() const noexcept
     {
         return _pip_counts[1] * 2;
     }
-    int threes() const noexcept
+    constexpr int threes() const noexcept
     {
         return _pip_counts[2] * 3;
     }
-    int fours() const noexcept
+    constexpr int fours() const noexcept
     {
         return _pip_counts[3] * 4;
     }
-    int fives() const noexcept
+    constexpr int fives() const noexcept
     {
         return _pip_counts[4] * 5;
     }
-    int sixes() const noexcept
+    constexpr int sixes() const noexcept
     {
         return _pip_counts[5] * 6;
     }
-    int three_of_a_kind() const noexcept
+    constexpr int three_of_a_kind() const noexcept
     {
         for (auto c : _pip_counts)
             if (c >= 3)
@@ -73,7 +104,7 @@ public:
 
         return 0;
     }
-    int four_of_a_kind() const noexcept
+    constexpr int four_of_a_kind() const noexcept
     {
         for (auto c : _pip_counts)
             if (c >= 4)
@@ -81,7 +112,7 @@ public:
 
         return 0;
     }
-    int full_house() const noexcept
+    constexpr int full_house() const noexcept
     {
         bool three{false};
 
@@ -98,7 +129,7 @@ public:
 
         return 0;
     }
-    int small_straight() const noexcept
+    constexpr int small_straight() const noexcept
     {
         if (   (_pip_counts[0] >= 1 && _pip_counts[1] >= 1 && _pip_counts[2] >= 1 && _pip_counts[3] >= 1)
             || (_pip_counts[1] >= 1 && _pip_counts[2] >= 1 && _pip_counts[3] >= 1 && _pip_counts[4] >= 1)
@@ -108,7 +139,7 @@ public:
         //    return 30;
         return 0;
     }
-    int large_straight() const noexcept
+    constexpr int large_straight() const noexcept
     {
         if (   (_pip_counts[0] == 1 && _pip_counts[1] == 1 && _pip_counts[2] == 1 && _pip_counts[3] == 1 && _pip_counts[4] == 1)
             || (_pip_counts[1] == 1 && _pip_counts[2] == 1 && _pip_counts[3] == 1 && _pip_counts[4] == 1 && _pip_counts[5] == 1))
@@ -117,7 +148,7 @@ public:
         //    return 40;
         return 0;
     }
-    int yahtzee() const noexcept
+    constexpr int yahtzee() const noexcept
     {
         for (auto c : _pip_counts)
             if (c == 5)
@@ -125,13 +156,39 @@ public:
 
         return 0;
     }
-    int chance() const noexcept
+    constexpr int chance() const noexcept
     {
         return sum_of_pips();
     }
 
+    ///
+    /// \brief  Calculate the score for a single category.
+    /// \param category The category to be scored.
+    /// \return The score the dice would earn in the given category.
+    ///
+    constexpr int score(Category category) const noexcept
+    {
+        switch (category)
+        {
+            case Category::Aces:            return aces();
+            case Category::Twos:            return twos();
+            case Category::Threes:          return threes();
+            case Category::Fours:           return fours();
+            case Category::Fives:           return fives();
+            case Category::Sixes:           return sixes();
+            case Category::ThreeOfAKind:    return three_of_a_kind();
+            case Category::FourOfAKind:     return four_of_a_kind();
+            case Category::FullHouse:       return full_house();
+            case Category::SmallStraight:   return small_straight();
+            case Category::LargeStraight:   return large_straight();
+            case Category::Yahtzee:         return yahtzee();
+            case Category::Chance:          return chance();
+        }
+        return 0;
+    }
+
 private:
-    int sum_of_pips() const noexcept
+    constexpr int sum_of_pips() const noexcept
     {
         return   (_pip_counts[0])
                + (_pip_counts[1] * 2)
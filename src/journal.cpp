@@ -0,0 +1,218 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gameengine.h"
+#include "journal.h"
+
+namespace {
+constexpr char          Magic[8]{'T', 'Y', 'T', 'Z', 'J', 'R', 'N', 'L'};
+constexpr std::uint32_t ByteOrder{0x01020304};
+
+///
+/// \brief The fixed header at the start of every journal file.
+///
+struct Header
+{
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   byte_order;         // detects journals written on a machine of different endianness
+    std::uint32_t   record_size;
+    std::uint32_t   reserved;
+    std::uint64_t   player_id;
+    std::int64_t    start_time;         // when the session began, in milliseconds since the Unix epoch
+};
+}   // anonymous namespace
+
+///
+/// \brief Journal::Journal Start a journal, creating its file.
+/// \param path         The location of the journal file. An existing file is replaced.
+/// \param player_id    The id of the player whose session is recorded.
+///
+/// If the file cannot be created the journal is not open, and records are
+/// discarded.
+Journal::Journal(const std::string &path, std::uint64_t player_id)
+  : _file{path, std::ios::binary | std::ios::trunc}
+  , _start{std::chrono::steady_clock::now()}
+{
+    if (!_file)
+        return;
+
+    Header  header{};
+
+    std::copy(std::begin(Magic), std::end(Magic), header.magic);
+    header.version = version;
+    header.byte_order = ByteOrder;
+    header.record_size = sizeof(Record);
+    header.player_id = player_id;
+    header.start_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    _file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!_file.flush())
+    {
+        _file.close();
+        return;
+    }
+
+    _open = true;
+    _pending.reserve(batch_size);
+    _writer = std::thread{&Journal::write_batches, this};
+}
+
+///
+/// \brief Journal::~Journal    Write any records not yet written and close the journal.
+///
+Journal::~Journal()
+{
+    if (!_writer.joinable())
+        return;
+
+    {
+        std::lock_guard lock{_mutex};
+
+        _stopping = true;
+    }
+    _wake.notify_one();
+    _writer.join();
+}
+
+///
+/// \brief Journal::record  Append an event to the journal.
+/// \param kind The kind of event.
+/// \param game The game, in its state after the event.
+/// \param cell The cell scored by a Score event.
+///
+/// A Game event is followed by a GameId event, so that both the master seed
+/// and the game id are recorded.
+void Journal::record(Kind kind, const GameEngine &game, std::uint8_t cell)
+{
+    if (!is_open())
+        return;
+
+    const auto  time{static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start).count())};
+    Record      record{time,
+                       kind,
+                       game.dice().keep_mask(),
+                       static_cast<std::uint8_t>(game.rolls_left()),
+                       cell,
+                       game.dice().encoding()};
+
+    switch (kind)
+    {
+    case Kind::Game:
+        record.cell = static_cast<std::uint8_t>(game.engine());
+        record.value = game.seed();
+        break;
+    case Kind::End:
+        record.value = static_cast<std::uint64_t>(game.grand_total());
+        break;
+    default:
+        break;
+    }
+
+    bool    full;
+    {
+        std::lock_guard lock{_mutex};
+
+        _pending.push_back(record);
+        if (kind == Kind::Game)
+            _pending.push_back(Record{time,
+                                      Kind::GameId,
+                                      record.keep_mask,
+                                      record.rolls_left,
+                                      static_cast<std::uint8_t>(GameEngine::max_plays - game.plays_left()),
+                                      game.game_id()});
+        full = _pending.size() >= batch_size;
+    }
+    if (full)
+        _wake.notify_one();
+}
+
+///
+/// \brief Journal::read    Read the records of a journal file.
+/// \param path         The location of the file.
+/// \param player_id    Receives the id of the player whose session the journal records.
+/// \param records      Receives the records.
+/// \return true if the file was read, false if it could not be read or is not
+///         a journal of this version. A record cut short at the end of the
+///         file, by a session that did not close cleanly, is ignored.
+///
+bool Journal::read(const std::string &path, std::uint64_t &player_id, std::vector<Record> &records)
+{
+    std::ifstream   file{path, std::ios::binary | std::ios::ate};
+
+    if (!file)
+        return false;
+
+    const auto  size{static_cast<size_t>(file.tellg())};
+    Header      header;
+
+    file.seekg(0);
+    if (size < sizeof(header) || !file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        return false;
+    if (   !std::equal(std::begin(Magic), std::end(Magic), header.magic)
+        || header.version != version
+        || header.byte_order != ByteOrder
+        || header.record_size != sizeof(Record))
+        return false;
+
+    records.resize((size - sizeof(header)) / sizeof(Record));
+    if (!file.read(reinterpret_cast<char *>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Record))))
+        return false;
+    player_id = header.player_id;
+
+    return true;
+}
+
+///
+/// \brief Journal::write_batches   Write appended records to the file until the journal is closed.
+///
+/// Runs on the writer thread. Records are written when a batch has built up,
+/// when they have waited for the flush interval, and when the journal closes.
+void Journal::write_batches()
+{
+    std::vector<Record> batch;
+
+    batch.reserve(batch_size);
+    for (bool stopping{false}; !stopping; )
+    {
+        {
+            std::unique_lock    lock{_mutex};
+
+            _wake.wait_for(lock, flush_interval, [this] { return _stopping || _pending.size() >= batch_size; });
+            batch.swap(_pending);
+            stopping = _stopping;
+        }
+
+        if (!batch.empty())
+        {
+            _file.write(reinterpret_cast<const char *>(batch.data()), static_cast<std::streamsize>(batch.size() * sizeof(Record)));
+            _file.flush();
+            batch.clear();
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GameEngine;
+
+///
+/// \brief An append-only journal of the events of a session of play.
+///
+/// A journal file begins with a fixed header identifying the file, its format
+/// version and the player, followed by fixed-width records, one per event, in
+/// the order they happened. Each record holds the state of the turn after the
+/// event. That state is enough to replay each game and to analyze the
+/// choices made in it.
+///
+/// Appending a record only copies it to a buffer in memory. A background
+/// thread writes the buffered records to the file in batches, so journalling
+/// does not slow down play.
+///
+class Journal
+{
+public:
+    ///
+    /// \brief The kinds of event recorded.
+    ///
+    enum class Kind : std::uint8_t
+    {
+        Game = 1,   // a game began; value is the master seed, cell the generator
+        GameId,     // follows Game; value is the game id, cell the turns already played
+        Roll,
+        Keep,
+        Score,      // cell is the column times 13 plus the category
+        Undo,
+        Redo,
+        End,        // the game ended; value is the final score
+    };
+
+    ///
+    /// \brief One event.
+    ///
+    struct Record
+    {
+        std::uint32_t   time;           // milliseconds since the session began
+        Kind            kind;
+        std::uint8_t    keep_mask;      // the state of the turn after the event
+        std::uint8_t    rolls_left;
+        std::uint8_t    cell;
+        std::uint64_t   value;          // the encoding of the dice, unless the kind says otherwise
+    };
+
+    static_assert(sizeof(Record) == 16);
+
+    static constexpr std::uint32_t  version{1};
+    static constexpr size_t         batch_size{256};    // records written together
+    static constexpr std::chrono::seconds   flush_interval{2};  // longest a record waits to be written
+
+    Journal(const std::string &path, std::uint64_t player_id);
+    ~Journal();
+
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+
+    ///
+    /// \brief  Determine whether the journal file is open.
+    ///
+    bool is_open() const noexcept
+    {
+        return _open;
+    }
+
+    void record(Kind kind, const GameEngine &game, std::uint8_t cell = 0);
+
+    static bool read(const std::string &path, std::uint64_t &player_id, std::vector<Record> &records);
+
+private:
+    void write_batches();
+
+    std::ofstream                           _file;      // written only by _writer once the journal is open
+    bool                                    _open{false};
+    std::chrono::steady_clock::time_point   _start;
+    std::mutex                              _mutex;
+    std::condition_variable                 _wake;
+    std::vector<Record>                     _pending;   // appended, not yet written; guarded by _mutex
+    bool                                    _stopping{false};
+    std::thread                             _writer;
+};
+
+#endif // JOURNAL_H
@@ -0,0 +1,155 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "keepadvisor.h"
+#include "rerolltable.h"
+#include "scoretable.h"
+
+///
+/// \brief KeepAdvisor::KeepAdvisor Construct a KeepAdvisor with no strategy.
+///
+KeepAdvisor::KeepAdvisor()
+  : _column{std::make_unique<ColumnSolver>()}
+{}
+
+///
+/// \brief KeepAdvisor::load    Use the strategy in a pair of strategy files.
+/// \param column_path  The location of a column strategy file. It is required.
+/// \param triple_path  The location of a Triple strategy file. It is optional.
+/// \return true if the column strategy was loaded, false otherwise.
+///
+bool KeepAdvisor::load(const std::string &column_path, const std::string &triple_path)
+{
+    auto    column{std::make_unique<ColumnSolver>()};
+
+    if (!column->load(column_path))
+        return false;
+
+    auto    triple{std::make_unique<TripleSolver>(*column, size_t{1} << 20)};
+
+    triple->load(triple_path);
+
+    _triple = std::move(triple);
+    _column = std::move(column);
+    _memo = {};
+    _ready = true;
+
+    return true;
+}
+
+///
+/// \brief KeepAdvisor::solve   Compute the column strategy and save it for later use.
+/// \param column_path  The location to write the column strategy file.
+/// \param threads      The number of threads to use, or zero to use one per hardware thread.
+/// \return true if the strategy was computed and saved, false if it could not be saved.
+///
+/// The advisor is ready to use once this function returns, even if the
+/// strategy could not be saved.
+bool KeepAdvisor::solve(const std::string &column_path, unsigned threads)
+{
+    auto    column{std::make_unique<ColumnSolver>()};
+
+    column->solve(threads);
+
+    const bool  saved{column->save(column_path)};
+
+    _triple = std::make_unique<TripleSolver>(*column, size_t{1} << 20);
+    _column = std::move(column);
+    _memo = {};
+    _ready = true;
+
+    return saved;
+}
+
+const TurnEvaluator::KeepValues &KeepAdvisor::keep_values(const TripleState &state, int rolls_left) const
+{
+    Memo   &memo{_memo[rolls_left]};
+    const auto  key{state.key()};
+
+    if (memo.key != key)
+    {
+        RollValues  values;
+
+        _triple->roll_values(state, rolls_left, values);
+        TurnEvaluator::keep_values(values, memo.values);
+        memo.key = key;
+    }
+
+    return memo.values;
+}
+
+///
+/// \brief KeepAdvisor::rank    Rank every way of keeping dice before a reroll.
+/// \param state        The state of the score sheet.
+/// \param dice         The dice showing.
+/// \param rolls_left   The number of rolls left in the turn, one or two.
+/// \return All 32 keep masks, from best to worst. Masks of equal value keep
+///         their ascending order.
+///
+/// The advisor must be ready, and the state must have at least one open cell.
+std::array<KeepAdvice, 32> KeepAdvisor::rank(const TripleState &state, const PackedDice &dice, int rolls_left) const
+{
+    const auto                 &values{keep_values(state, rolls_left - 1)};
+    std::array<KeepAdvice, 32>  ranked;
+
+    for (unsigned mask{0}; mask < ranked.size(); ++mask)
+        ranked[mask] = KeepAdvice{static_cast<std::uint8_t>(mask), values[RerollTable::keep_index(dice, static_cast<std::uint8_t>(mask))]};
+
+    std::stable_sort(ranked.begin(), ranked.end(), [](const KeepAdvice &lhs, const KeepAdvice &rhs) { return lhs.value > rhs.value; });
+
+    return ranked;
+}
+
+///
+/// \brief KeepAdvisor::rank    Rank every way of keeping dice in a game in progress.
+/// \param game The game. Its dice must have been rolled, with a roll left.
+/// \return All 32 keep masks, from best to worst.
+///
+std::array<KeepAdvice, 32> KeepAdvisor::rank(const GameEngine &game) const
+{
+    return rank(TripleState::from(game), game.dice(), game.rolls_left());
+}
+
+///
+/// \brief KeepAdvisor::best_cell   Determine the best cell to score the dice in.
+/// \param game The game. Its dice must have been rolled, with a cell left open.
+///
+TripleCell KeepAdvisor::best_cell(const GameEngine &game) const
+{
+    return _triple->best_cell(TripleState::from(game), ScoreTable::index(game.dice()));
+}
+
+///
+/// \brief KeepAdvisor::cell_values Calculate the value of scoring the dice in each cell.
+/// \param game The game. Its dice must have been rolled.
+/// \param out  Receives, for each open cell, the points scoring in it earns
+///             plus the expected score of the rest of the game, indexed by
+///             column times 13 plus category. Filled cells receive -1.
+///
+void KeepAdvisor::cell_values(const GameEngine &game, TripleSolver::CellValues &out) const
+{
+    _triple->cell_values(TripleState::from(game), ScoreTable::index(game.dice()), out);
+}
@@ -0,0 +1,95 @@
+#ifndef KEEPADVISOR_H
+#define KEEPADVISOR_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "columnsolver.h"
+#include "gameengine.h"
+#include "packeddice.h"
+#include "triplesolver.h"
+#include "turnevaluator.h"
+
+///
+/// \brief The expected value of keeping a particular set of dice.
+///
+struct KeepAdvice
+{
+    std::uint8_t    mask;       // bit n is set when die n is kept
+    float           value;      // expected score of the rest of the game
+};
+
+///
+/// \brief Ranks the ways to keep dice before a reroll.
+///
+/// The advisor values each of the 32 keep masks by the expected score of the
+/// rest of the game, taking into account the rolls left and the open cells of
+/// all three columns. It works from the solvers' precomputed value tables and
+/// the \c RerollTable transition tables, so ranking a roll takes well under a
+/// millisecond. Values for the current turn are computed once and reused for
+/// each roll in the turn.
+///
+/// A KeepAdvisor is not safe to use from more than one thread at a time.
+///
+class KeepAdvisor
+{
+public:
+    KeepAdvisor();
+
+    bool load(const std::string &column_path, const std::string &triple_path);
+    bool solve(const std::string &column_path, unsigned threads = 0);
+
+    ///
+    /// \brief  Determine whether the advisor has a strategy to give advice from.
+    ///
+    bool is_ready() const noexcept
+    {
+        return _ready;
+    }
+
+    std::array<KeepAdvice, 32> rank(const TripleState &state, const PackedDice &dice, int rolls_left) const;
+    std::array<KeepAdvice, 32> rank(const GameEngine &game) const;
+    TripleCell best_cell(const GameEngine &game) const;
+    void cell_values(const GameEngine &game, TripleSolver::CellValues &out) const;
+
+private:
+    ///
+    /// \brief The keep values of one stage of a turn, as last computed.
+    ///
+    struct Memo
+    {
+        std::uint64_t               key{~std::uint64_t{0}};
+        TurnEvaluator::KeepValues   values;
+    };
+
+    const TurnEvaluator::KeepValues &keep_values(const TripleState &state, int rolls_left) const;
+
+    std::unique_ptr<ColumnSolver>   _column;
+    std::unique_ptr<TripleSolver>   _triple;
+    bool                            _ready{false};
+    mutable std::array<Memo, GameEngine::max_rolls>  _memo;     // indexed by rerolls left after the keep
+};
+
+#endif // KEEPADVISOR_H
@@ -0,0 +1,366 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include "leaderboard.h"
+
+namespace {
+constexpr char          Magic[8]{'T', 'Y', 'T', 'Z', 'S', 'C', 'O', 'R'};
+constexpr std::uint32_t ByteOrder{0x01020304};
+
+///
+/// \brief The fixed header at the start of every leaderboard file.
+///
+struct Header
+{
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   byte_order;         // detects files written on a machine of different endianness
+};
+
+///
+/// \brief The fixed part of a record, followed in the file by the name.
+///
+struct Record
+{
+    std::int64_t    when;
+    std::int32_t    score;
+    std::uint16_t   name_size;
+    std::uint16_t   reserved;
+};
+
+static_assert(sizeof(Header) == 16);
+static_assert(sizeof(Record) == 16);
+
+///
+/// \brief Read the header of a leaderboard file.
+/// \param file The open file.
+/// \param size Receives the length of the file.
+/// \return true if the file is a leaderboard of this version, false otherwise.
+///
+bool read_header(std::ifstream &file, std::uint64_t &size)
+{
+    Header  header;
+
+    file.seekg(0, std::ios::end);
+    size = static_cast<std::uint64_t>(file.tellg());
+    file.seekg(0);
+
+    return    size >= sizeof(header)
+           && file.read(reinterpret_cast<char *>(&header), sizeof(header))
+           && std::equal(std::begin(Magic), std::end(Magic), header.magic)
+           && header.version == Leaderboard::version
+           && header.byte_order == ByteOrder;
+}
+
+///
+/// \brief Read the record at the file's read position, if it is whole.
+/// \param file     The open file, positioned at the start of a record.
+/// \param size     The length of the file.
+/// \param offset   The offset of the record. Advanced past it if it is read.
+/// \param entry    Receives the record's entry.
+/// \return true if a whole record was read, false at the end of the file or
+///         at a record cut short.
+///
+bool read_entry(std::ifstream &file, std::uint64_t size, std::uint64_t &offset, Leaderboard::Entry &entry)
+{
+    Record  record;
+
+    if (   offset + sizeof(record) > size
+        || !file.read(reinterpret_cast<char *>(&record), sizeof(record))
+        || offset + sizeof(record) + record.name_size > size)
+        return false;
+
+    entry = Leaderboard::Entry{record.score, record.when, std::string(record.name_size, '\0')};
+    if (!file.read(entry.name.data(), record.name_size))
+        return false;
+    offset += sizeof(record) + record.name_size;
+
+    return true;
+}
+}   // anonymous namespace
+
+///
+/// \brief Leaderboard::open    Prepare to add entries after the last whole record in the file.
+/// \return true if entries will be added to the file, false if there is a file
+///         that is not a leaderboard of this version or cannot be cut back to
+///         its last whole record.
+///
+/// Every record is read to find the end of the last whole one, so callers
+/// that know where it is should give it to \c open(size) instead.
+bool Leaderboard::open()
+{
+    std::uint64_t   offset{0};
+
+    while (const auto page{this->page(offset, scan_page)})
+    {
+        offset = page->next;
+        if (page->entries.size() < scan_page)
+            break;
+    }
+    open(offset);
+
+    return _file_state != FileState::Unusable;
+}
+
+///
+/// \brief Leaderboard::open    Prepare to add entries without reading those already held.
+/// \param size The length of the file up to the end of its last whole record:
+///             the \c next offset of the last page read from the file, or
+///             \c file_size() when the file was last written.
+/// \return true if entries will follow on from the first \c size bytes of
+///         the file, or there is no file and \c size is zero. false if the
+///         file holds whole records after \c size, is shorter than \c size,
+///         or is unusable; the caller's view of the file is then out of date.
+///
+/// Nothing before \c size is read, so opening and adding entries take
+/// constant time however many the file holds. A record cut short after
+/// \c size is cut off.
+bool Leaderboard::open(std::uint64_t size)
+{
+    _file_size = 0;
+    _opened = true;
+
+    std::ifstream   file{_path, std::ios::binary};
+    std::uint64_t   length;
+
+    if (!file)
+    {
+        _file_state = missing_or_unusable();
+        return _file_state == FileState::Missing && size == 0;
+    }
+    if (!read_header(file, length))
+    {
+        _file_state = FileState::Unusable;
+        return false;
+    }
+
+    std::uint64_t   offset{size};
+    Entry           entry;
+
+    if (size < sizeof(Header) || size > length || (file.seekg(static_cast<std::streamoff>(size)), read_entry(file, length, offset, entry)))
+    {
+        _opened = false;
+        return false;
+    }
+    file.close();
+    follow(size, length);
+
+    return true;
+}
+
+///
+/// \brief Leaderboard::add Add an entry, appending it to the file.
+/// \param entry    The entry to add.
+/// \return true if the entry was stored in the file, false if it was not.
+///
+/// The leaderboard is opened first if it has not been. A new file is started
+/// only when there is none; an unusable file is left as it is.
+bool Leaderboard::add(Entry entry)
+{
+    if (!_opened)
+        open();
+    if (entry.name.size() > max_name_size)
+        entry.name.resize(max_name_size);
+
+    return append(entry);
+}
+
+///
+/// \brief Leaderboard::clear   Remove every entry, emptying the file.
+/// \return true if the file was emptied, false otherwise.
+///
+/// This is the only way an unusable file is replaced.
+bool Leaderboard::clear()
+{
+    _file_size = 0;
+    _opened = true;
+
+    if (create())
+        return true;
+    _file_state = missing_or_unusable();
+
+    return false;
+}
+
+///
+/// \brief Leaderboard::page    Read entries from the file, in the order they were added.
+/// \param offset   Where to start: zero for the first entry, or the \c next
+///                 offset of the page before.
+/// \param count    The most entries to read.
+/// \return Up to \c count entries and the offset following them; fewer when
+///         the end of the file is reached. An empty \c std::optional if there
+///         is no file, it is not a leaderboard of this version, or it is
+///         shorter than \c offset.
+///
+/// Reads only the records it returns, so any part of a long history can be
+/// shown a page at a time.
+std::optional<Leaderboard::Page> Leaderboard::page(std::uint64_t offset, size_t count) const
+{
+    std::ifstream   file{_path, std::ios::binary};
+    std::uint64_t   size;
+
+    if (!file || !read_header(file, size))
+        return std::nullopt;
+
+    Page    page{{}, std::max<std::uint64_t>(offset, sizeof(Header))};
+    Entry   entry;
+
+    if (page.next > size)
+        return std::nullopt;
+    file.seekg(static_cast<std::streamoff>(page.next));
+    while (page.entries.size() < count && read_entry(file, size, page.next, entry))
+        page.entries.push_back(std::move(entry));
+
+    return page;
+}
+
+///
+/// \brief Leaderboard::append  Append an entry's record to the file.
+/// \param entry    The entry.
+/// \return true if the record was written, false otherwise.
+///
+/// A new file is started if there is none. A failed append leaves the file
+/// as it was, or marks it unusable if it cannot.
+bool Leaderboard::append(const Entry &entry)
+{
+    if (_file_state == FileState::Unusable || (_file_state == FileState::Missing && !create()))
+        return false;
+
+    const Record    record{entry.when, entry.score, static_cast<std::uint16_t>(entry.name.size()), 0};
+    std::ofstream   file{_path, std::ios::binary | std::ios::app};
+
+    file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    file.write(entry.name.data(), static_cast<std::streamsize>(record.name_size));
+    if (!file.flush())
+    {
+        // Leave the file as it was, so the next record follows the last whole one.
+        file.close();
+
+        std::error_code error;
+
+        std::filesystem::resize_file(_path, _file_size, error);
+        if (error)
+            _file_state = FileState::Unusable;
+        return false;
+    }
+    _file_size += sizeof(record) + record.name_size;
+
+    return true;
+}
+
+///
+/// \brief Leaderboard::follow  Make the file ready for entries to follow its first whole records.
+/// \param offset   The end of the last whole record.
+/// \param size     The length of the file. Anything after \c offset is a record cut short, and is cut off.
+///
+/// If the file cannot be cut back, it is marked unusable.
+void Leaderboard::follow(std::uint64_t offset, std::uint64_t size)
+{
+    if (offset < size)
+    {
+        std::error_code error;
+
+        std::filesystem::resize_file(_path, offset, error);
+        if (error)
+        {
+            _file_state = FileState::Unusable;    // entries cannot be added after the damaged record
+            return;
+        }
+    }
+    _file_size = offset;
+    _file_state = FileState::Ready;
+}
+
+///
+/// \brief Leaderboard::create  Start a new file holding only the header.
+/// \return true if the file was written, false otherwise.
+///
+/// The header is written to a temporary file that then replaces the file, so
+/// a failed write leaves the old file as it was.
+bool Leaderboard::create()
+{
+    const std::string   temp{_path + ".tmp"};
+
+    {
+        std::ofstream   file{temp, std::ios::binary | std::ios::trunc};
+        Header          header{};
+
+        if (!file)
+            return false;
+
+        std::copy(std::begin(Magic), std::end(Magic), header.magic);
+        header.version = version;
+        header.byte_order = ByteOrder;
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (!file.flush())
+        {
+            file.close();
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+
+#if defined(_WIN32)
+    const bool  renamed{MoveFileExA(temp.c_str(), _path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0};
+#else
+    const bool  renamed{std::rename(temp.c_str(), _path.c_str()) == 0};
+#endif
+
+    if (!renamed)
+    {
+        std::remove(temp.c_str());
+        return false;
+    }
+    _file_size = sizeof(Header);
+    _file_state = FileState::Ready;
+
+    return true;
+}
+
+///
+/// \brief Leaderboard::missing_or_unusable Classify a file that cannot be used.
+/// \return Missing if there is no file, so that one may be started, or
+///         Unusable if there is one or it cannot be told whether there is.
+///
+Leaderboard::FileState Leaderboard::missing_or_unusable() const
+{
+    std::error_code error;
+    const auto      status{std::filesystem::status(_path, error)};
+
+    return status.type() == std::filesystem::file_type::not_found ? FileState::Missing : FileState::Unusable;
+}
@@ -0,0 +1,163 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+///
+/// \brief The full history of scored games.
+///
+/// The history is stored in an append-only file: a fixed header identifying
+/// the file and its format version, then one record per entry in the order
+/// the entries were added. Adding an entry appends one record, so the file is
+/// never rewritten as it grows. A record cut short by a crash while it was
+/// being appended is cut off when the leaderboard is next opened.
+///
+/// No entries are held in memory. The history is read on demand, a page at a
+/// time, in the order it was added. Callers that need the best entries keep
+/// them themselves, with the length of the file when they were taken: later
+/// they read only the records added after that length, and then open the
+/// leaderboard to add entries without reading the rest.
+///
+class Leaderboard
+{
+public:
+    ///
+    /// \brief The version of the file format.
+    ///
+    static constexpr std::uint32_t  version{1};
+
+    ///
+    /// \brief The longest name stored, in bytes. Longer names are cut short.
+    ///
+    static constexpr size_t max_name_size{0xFFFF};
+
+    ///
+    /// \brief The records read at a time when the whole file is read.
+    ///
+    static constexpr size_t scan_page{4096};
+
+    ///
+    /// \brief One scored game.
+    ///
+    struct Entry
+    {
+        std::int32_t    score;
+        std::int64_t    when;       // milliseconds since the Unix epoch
+        std::string     name;       // UTF-8
+    };
+
+    ///
+    /// \brief Entries read from the file, and where the next ones start.
+    ///
+    struct Page
+    {
+        std::vector<Entry>  entries;
+        std::uint64_t       next;       // the offset of the record after the last one read
+    };
+
+    ///
+    /// \brief Construct an empty leaderboard stored in a file.
+    /// \param path The location of the file. Nothing is read until the leaderboard is opened or a page is read.
+    ///
+    explicit Leaderboard(std::string path)
+      : _path{std::move(path)}
+    {}
+
+    bool open();
+    bool open(std::uint64_t size);
+    bool add(Entry entry);
+    bool clear();
+    std::optional<Page> page(std::uint64_t offset, size_t count) const;
+
+    ///
+    /// \brief  Retrieve the location of the file.
+    ///
+    const std::string &path() const noexcept
+    {
+        return _path;
+    }
+
+    ///
+    /// \brief  Determine whether the file has been opened, so that entries can be added without reading it.
+    ///
+    bool opened() const noexcept
+    {
+        return _opened;
+    }
+
+    ///
+    /// \brief  Retrieve the length of the file, up to the end of the last whole record.
+    /// \return The length in bytes, or zero if there is no valid file or it has not been opened.
+    ///
+    std::uint64_t file_size() const noexcept
+    {
+        return _file_state == FileState::Ready ? _file_size : 0;
+    }
+
+    ///
+    /// \brief  Determine whether there is no file, so that the next entry added starts one.
+    ///
+    bool missing() const noexcept
+    {
+        return _opened && _file_state == FileState::Missing;
+    }
+
+    ///
+    /// \brief  Determine whether there is a file that entries cannot be added to.
+    ///
+    /// The file is not a leaderboard of this version, or it could not be
+    /// read or cut back to its last whole record. It is left as it is, and
+    /// no entries are stored until the leaderboard is cleared.
+    ///
+    bool unusable() const noexcept
+    {
+        return _file_state == FileState::Unusable;
+    }
+
+private:
+    ///
+    /// \brief What is known of the file.
+    ///
+    enum class FileState
+    {
+        Missing,        // there is no file; the next entry added starts one
+        Ready,          // entries are appended after the first _file_size bytes
+        Unusable,       // the file is not left fit to append to, and is never replaced
+    };
+
+    bool append(const Entry &entry);
+    void follow(std::uint64_t offset, std::uint64_t size);
+    bool create();
+    FileState missing_or_unusable() const;
+
+    std::string         _path;
+    std::uint64_t       _file_size{0};      // the bytes of the file holding whole records, when it is Ready
+    FileState           _file_state{FileState::Missing};
+    bool                _opened{false};     // _file_state is known
+};
+
+#endif // LEADERBOARD_H
@@ -20,11 +20,13 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QLocale>
 #include <QStandardPaths>
 #include <QTranslator>
 
 #include "config.h"
+#include "facegenerator.h"
 
 int main(int argc, char *argv[])
 {
@@ -44,7 +46,26 @@ int main(int argc, char *argv[])
 
     Config  config{QStandardPaths::writableLocation(QStandardPaths::StandardLocation::GenericConfigLocation) + "/.tripleytz"};
     config.load();
-    MainWindow w(config);
+    QCommandLineParser  parser;
+    QCommandLineOption  seed_option{"seed", QApplication::translate("main", "Master seed of a game to replay."), "seed"};
+    QCommandLineOption  game_option{"game", QApplication::translate("main", "Id of the game to replay, default 0."), "id", "0"};
+    QCommandLineOption  rng_option{"rng", QApplication::translate("main", "Generator the dice are rolled with: xoshiro, pcg, mt or philox."), "name", "xoshiro"};
+    QCommandLineOption  turbo_option{"turbo", QApplication::translate("main", "Start in turbo mode, with the dice coming to rest at once.")};
+
+    parser.addHelpOption();
+    parser.addOptions({seed_option, game_option, rng_option, turbo_option});
+    parser.process(a);
+
+    const auto  engine{FaceGenerator::engine_from_name(parser.value(rng_option).toStdString())};
+
+    if (!engine)
+        parser.showHelp(EXIT_FAILURE);
+
+    MainWindow w(config, QStandardPaths::writableLocation(QStandardPaths::StandardLocation::AppDataLocation));
+
+    if (parser.isSet(seed_option))
+        w.replay(parser.value(seed_option).toULongLong(), parser.value(game_option).toULongLong(), *engine);
+    w.turbo(parser.isSet(turbo_option));
     w.show();
     return a.exec();
 }
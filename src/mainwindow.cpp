@@ -20,8 +20,13 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QStatusBar>
+#include <QStringList>
 #include <QVBoxLayout>
 
 #include <array>
@@ -29,12 +34,8 @@
 
 #include "gamescorer.h"
 #include "highscoresdialog.h"
-#include "ace.xpm"
-#include "two.xpm"
-#include "three.xpm"
-#include "four.xpm"
-#include "five.xpm"
-#include "six.xpm"
+#include "savedgame.h"
+#include "scoretable.h"
 
 namespace {
 void set_score_arrays(const ScoreRow *row,
@@ -50,7 +51,7 @@ void set_score_arrays(const ScoreRow *row,
 }
 }   // anonymous namespace
 
-MainWindow::MainWindow(Config &config, QWidget *parent)
+MainWindow::MainWindow(Config &config, const QString &data_path, QWidget *parent)
   : QMainWindow(parent)
   , ui(new Ui::MainWindow)
   , _aces{new ScoreRow{tr("Aces")}}
@@ -73,9 +74,12 @@ MainWindow::MainWindow(Config &config, QWidget *parent)
   , _upper_section_total{new ScoreRow{tr("Upper Section Total")}}
   , _combined_total{new ScoreRow{tr("Combined Total")}}
   , _total{new ScoreRow{tr("Total Score")}}
-  , _dice_pix{nullptr}
+  , _category_rows{_aces, _twos, _threes, _fours, _fives, _sixes,
+                   _three_of_a_kind, _four_of_a_kind, _full_house,
+                   _small_straight, _large_straight, _yahtzee, _chance}
   , _dice_btn{nullptr}
   , _dice_chk{nullptr}
+  , _save_path{QDir{data_path}.filePath("game.sav")}
   , _config{config}
 {
     ui->setupUi(this);
@@ -151,20 +155,13 @@ MainWindow::MainWindow(Config &config, QWidget *parent)
     layout->addWidget(_grand_total);
 
 
-    _dice_pix[0] = new QPixmap(ace_xpm);
-    _dice_pix[1] = new QPixmap(two_xpm);
-    _dice_pix[2] = new QPixmap(three_xpm);
-    _dice_pix[3] = new QPixmap(four_xpm);
-    _dice_pix[4] = new QPixmap(five_xpm);
-    _dice_pix[5] = new QPixmap(six_xpm);
-
     QHBoxLayout *hbl{new QHBoxLayout{}};
     for (size_t i{0}; i < 5; ++i)
     {
-        _dice_btn[i] = new QPushButton(*_dice_pix[i], "");
+        _dice_btn[i] = new QPushButton(_sprites.icon(static_cast<int>(i) + 1, devicePixelRatioF()), "");
         _dice_btn[i]->setFlat(true);
-        _dice_btn[i]->setIconSize(_dice_pix[i]->size());
-        _dice_btn[i]->setFixedSize(_dice_pix[i]->size());
+        _dice_btn[i]->setIconSize(DiceSprites::size());
+        _dice_btn[i]->setFixedSize(DiceSprites::size());
         _dice_chk[i] = new QCheckBox(tr("Keep"));
         _dice_chk[i]->setEnabled(false);
         QVBoxLayout *vbl{new QVBoxLayout{}};
@@ -181,7 +178,7 @@ MainWindow::MainWindow(Config &config, QWidget *parent)
     hlayout->addWidget(_btn_roll);
     layout->addLayout(hlayout);
 
-    enable_undo(false);
+    update_undo_actions();
     update_roll_button();
 
     setFixedSize(sizeHint());
@@ -229,8 +226,6 @@ MainWindow::MainWindow(Config &config, QWidget *parent)
     connect(_chance, &ScoreRow::on_exit, this, &MainWindow::score_exited);
     connect(_chance, &ScoreRow::on_click, this, &MainWindow::score_clicked);
 
-    connect(_total, &ScoreRow::on_changed, this, &MainWindow::row_changed);
-
     connect(_dice_btn[0], &QPushButton::clicked, this, &MainWindow::die_0_clicked);
     connect(_dice_btn[1], &QPushButton::clicked, this, &MainWindow::die_1_clicked);
     connect(_dice_btn[2], &QPushButton::clicked, this, &MainWindow::die_2_clicked);
@@ -242,6 +237,9 @@ MainWindow::MainWindow(Config &config, QWidget *parent)
     connect(_dice_chk[3], &QAbstractButton::toggled, this, &MainWindow::keep_3_toggled);
     connect(_dice_chk[4], &QAbstractButton::toggled, this, &MainWindow::keep_4_toggled);
     connect(&_dice, &Dice::on_die_changed, this, &MainWindow::die_changed);
+    connect(&_dice, &Dice::on_dice_changed, this, &MainWindow::dice_changed);
+    connect(&_dice, &Dice::on_roll_finished, this, &MainWindow::roll_finished);
+    connect(&_config, &Config::saved, this, &MainWindow::config_saved);
 
     connect(_btn_roll, &QPushButton::clicked, this, &MainWindow::roll_clicked);
 
@@ -272,157 +270,333 @@ MainWindow::MainWindow(Config &config, QWidget *parent)
     set_score_arrays(_upper_section_total, 17, singles, doubles, triples);
     set_score_arrays(_combined_total,      18, singles, doubles, triples);
     set_score_arrays(_total,               19, singles, doubles, triples);
-    _column_single = new ScoreColumn{1, singles};
-    _column_double = new ScoreColumn{2, doubles};
-    _column_triple = new ScoreColumn{3, triples};
+    _column_single = new ScoreColumn{_game.sheet(), 0, singles};
+    _column_double = new ScoreColumn{_game.sheet(), 1, doubles};
+    _column_triple = new ScoreColumn{_game.sheet(), 2, triples};
+
+    load_advisor(data_path);
+
+    _save_pool.setMaxThreadCount(1);
+    QDir{data_path}.mkpath(".");
+    start_journal(data_path);
+    resume_game();
+    _journal->record(Journal::Kind::Game, _game);
 }
 
 MainWindow::~MainWindow()
 {
+    autosave();
+    _save_pool.waitForDone();
+
+    if (_advisor_thread)
+    {
+        _advisor_thread->wait();
+        delete _advisor_thread;
+    }
+
     delete ui;
 
     delete _column_single;
     delete _column_double;
     delete _column_triple;
-
-    for (auto dp : _dice_pix)
-        delete dp;
 }
 
 void MainWindow::end_game()
 {
-    assert(_grand_total->total().has_value());
-    int game_score = _grand_total->total().value_or(0);
+    assert(_game.game_over());
+    int game_score = _game.grand_total();
+
+    _journal->record(Journal::Kind::End, _game);
 
     QString     msg{tr("Your final score is %1!").arg(game_score)};
     QMessageBox mb{QMessageBox::Icon::Information, "TripleYtz", msg, QMessageBox::StandardButton::Ok, this};
 
     mb.exec();
 
-    // handle high scores
+    // every score is recorded, under the last name used unless the player
+    // makes the high score list and gives another; an empty name is never used
+    QString name{_config.last_used_name()};
+    bool    named{false};
+
     if (_config.is_high_score(game_score))
     {
-        bool    ok;
-        QString name = QInputDialog::getText(this, tr("High Score!"),
-                                             tr("You made it to the high score list.\nPlease enter your name:"),
-                                             QLineEdit::Normal, _config.last_used_name(), &ok);
-        if (ok)
+        const QString   entered{QInputDialog::getText(this, tr("High Score!"),
+                                                      tr("You made it to the high score list.\nPlease enter your name:"),
+                                                      QLineEdit::Normal, name, &named).trimmed()};
+
+        if (named && !entered.isEmpty())
         {
+            name = entered;
             _config.last_used_name(name);
-            if (_config.add_high_score(game_score, name))
-            {
-                _config.save();
-                show_high_scores_list();
-            }
         }
     }
+    if (name.isEmpty())
+        name = tr("Anonymous");
+
+    const bool  high{_config.add_high_score(game_score, name)};
+
+    _config.save();     // so the next session need not read the leaderboard to find the high scores
+    if (high && named)
+        show_high_scores_list();
 
     new_game();
 }
 
 void MainWindow::new_game()
 {
-    _current_score_widget = nullptr;
-
-    _aces->reset();
-    _twos->reset();
-    _threes->reset();
-    _fours->reset();
-    _fives->reset();
-    _sixes->reset();
-    _three_of_a_kind->reset();
-    _four_of_a_kind->reset();
-    _full_house->reset();
-    _small_straight->reset();
-    _large_straight->reset();
-    _yahtzee->reset();
-    _chance->reset();
-    update_grand_total(_total);
-
-    _dice.reset();
-
-    _rolls_left = 3;
-    _plays_left = 39;
+    _game.new_game();
+    _journal->record(Journal::Kind::Game, _game);
+    show_game();
+    setWindowTitle(tr("Triple Yahtzee"));
+    autosave();
+}
+
+///
+/// \brief  Start a particular game, so that it can be played again.
+/// \param seed     The master seed of the game.
+/// \param game_id  The id of the game under the master seed.
+/// \param engine   The pseudo-random generator the game's dice were rolled with.
+///
+/// Games started afterwards follow on from the replayed game under the same
+/// master seed.
+void MainWindow::replay(std::uint64_t seed, std::uint64_t game_id, FaceGenerator::Engine engine)
+{
+    _game = GameEngine{seed, engine};
+    _game.new_game(seed, game_id);
+    _journal->record(Journal::Kind::Game, _game);
+    show_game();
+    setWindowTitle(tr("Triple Yahtzee - seed %1, game %2").arg(seed).arg(game_id));
+    autosave();
+}
+
+///
+/// \brief  Resume the game saved when the game was last played, if any.
+///
+void MainWindow::resume_game()
+{
+    SavedGame   saved;
+
+    if (saved.read(QFile::encodeName(_save_path).toStdString()) && saved.restore(_game))
+        show_game();
+}
+
+///
+/// \brief  Save the game in progress in the background.
+///
+/// The game is encoded at once, and written to the save file on a worker
+/// thread so that saving never holds up play.
+///
+void MainWindow::autosave()
+{
+    _save_pool.start([saved = SavedGame{_game}, path = QFile::encodeName(_save_path).toStdString()]
+                     {
+                         saved.write(path);
+                     });
+}
+
+///
+/// \brief  Start the journal of this session's play.
+/// \param data_path    The directory holding the \c journal directory, where each session's journal is kept.
+///
+void MainWindow::start_journal(const QString &data_path)
+{
+    const QDir      dir{QDir{data_path}.filePath("journal")};
+    const QString   name{QDateTime::currentDateTimeUtc().toString("yyyyMMdd-HHmmss-zzz") + ".tyj"};
+
+    dir.mkpath(".");
+    _journal = std::make_unique<Journal>(QFile::encodeName(dir.filePath(name)).toStdString(), _config.player_id());
+}
+
+///
+/// \brief  Show the score sheet, the dice and the state of the turn held by the engine.
+///
+/// Any roll still bouncing is abandoned.
+///
+void MainWindow::show_game()
+{
+    const auto &dice{_game.dice()};
+
+    show_sheet();
+    _dice.show(dice);
+
+    for (size_t i{0}; i < _dice_chk.size(); ++i)
+    {
+        _dice_chk[i]->setChecked(dice.is_kept(i));
+        _dice_chk[i]->setEnabled(_game.has_rolled());
+    }
+    _btn_roll->setEnabled(_game.can_roll());
     update_roll_button();
-    _btn_roll->setEnabled(true);
-    enable_undo(false);
-    for (auto k : _dice_chk)
+    update_undo_actions();
+    update_keep_hint();
+}
+
+///
+/// \brief  Load the strategy the keep hints are drawn from.
+/// \param data_path    The directory holding the strategy files.
+///
+/// If there is no column strategy file yet, it is computed on a background
+/// thread and saved for next time. Hints are shown once it is ready.
+///
+void MainWindow::load_advisor(const QString &data_path)
+{
+    const QDir      dir{data_path};
+    const QString   column_path{dir.filePath("column.tbl")};
+    const QString   triple_path{dir.filePath("triple.tbl")};
+    auto            advisor{std::make_unique<KeepAdvisor>()};
+
+    if (advisor->load(column_path.toStdString(), triple_path.toStdString()))
     {
-        k->setChecked(false);
-        k->setEnabled(false);
+        _advisor = std::move(advisor);
+        return;
     }
+
+    dir.mkpath(".");
+    statusBar()->showMessage(tr("Computing strategy for keep hints..."));
+    _advisor_thread = QThread::create([this, column_path]
+                                      {
+                                          auto  solved{std::make_unique<KeepAdvisor>()};
+
+                                          solved->solve(column_path.toStdString());
+                                          _solved_advisor = std::move(solved);
+                                      });
+    connect(_advisor_thread, &QThread::finished, this, &MainWindow::advisor_solved);
+    _advisor_thread->start(QThread::LowPriority);
 }
 
-void MainWindow::update_roll_button()
+///
+/// \brief  Highlight the best dice to keep for the next roll.
+///
+/// The Keep checkboxes of the suggested dice are highlighted, and the
+/// suggestion is shown in the status bar with its expected final score: the
+/// points already scored plus those the advisor expects still to come.
+///
+void MainWindow::update_keep_hint()
 {
-    _btn_roll->setText(tr("Roll! (%1 left)").arg(_rolls_left));
+    clear_keep_hint();
+
+    if (!_advisor || !ui->action_Keep_Hints->isChecked() || !_game.has_rolled() || !_game.can_roll())
+        return;
+
+    const auto  best{_advisor->rank(_game).front()};
+    QStringList faces;
+
+    for (size_t i{0}; i < _dice_chk.size(); ++i)
+        if (best.mask & (1u << i))
+        {
+            _dice_chk[i]->setStyleSheet("color: green; font-weight: bold");
+            faces << QString::number(_game.dice().face(i));
+        }
+
+    const QString   keep{faces.isEmpty() ? tr("Suggested: roll all dice") : tr("Suggested: keep %1").arg(faces.join(' '))};
+
+    statusBar()->showMessage(tr("%1 (expected final score %2)").arg(keep).arg(_game.grand_total() + best.value, 0, 'f', 0));
 }
 
-int MainWindow::get_score_value(const Score *score)
+///
+/// \brief  Remove any keep hint.
+///
+void MainWindow::clear_keep_hint()
 {
-    ScoreRow    *sr = static_cast<ScoreRow *>(score->parent());
-    if (sr == _aces)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.aces();});
-    else if (sr == _twos)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.twos();});
-    else if (sr == _threes)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.threes();});
-    else if (sr == _fours)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.fours();});
-    else if (sr == _fives)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.fives();});
-    else if (sr == _sixes)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.sixes();});
-    else if (sr == _three_of_a_kind)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.three_of_a_kind();});
-    else if (sr == _four_of_a_kind)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.four_of_a_kind();});
-    else if (sr == _full_house)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.full_house();});
-    else if (sr == _small_straight)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.small_straight();});
-    else if (sr == _large_straight)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.large_straight();});
-    else if (sr == _yahtzee)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.yahtzee();});
-    else if (sr == _chance)
-        return sr->get_score_value(_dice, [](const GameScorer &gs){return gs.chance();});
-    else
-        return 0;
+    for (auto k : _dice_chk)
+        k->setStyleSheet(QString{});
+    statusBar()->clearMessage();
 }
 
-void MainWindow::show_high_scores_list()
+///
+/// \brief  Show the engine's score sheet in the Score widgets.
+///
+void MainWindow::show_sheet()
 {
-    HighScoresDialog    dlg{_config, this};
+    {
+        const auto  transaction{score_transaction()};
 
-    dlg.exec();
+        _column_single->refresh();
+        _column_double->refresh();
+        _column_triple->refresh();
+    }
+    update_grand_total();
 }
 
-void MainWindow::update_grand_total(ScoreRow *row)
+///
+/// \brief  Begin a transaction over the whole score sheet.
+/// \return A transaction that ends when it is destroyed.
+///
+/// Changes to many cells made while the transaction is open lead to one
+/// refresh of each column and one repaint.
+///
+ScoreTransaction MainWindow::score_transaction()
 {
-    std::optional<int>  opt;
-    int total{0};
-    auto [s, d, t] = row->get_scores();
+    return ScoreTransaction{ui->centralwidget, {_column_single, _column_double, _column_triple}};
+}
 
-    if (s->has_score())
-    {
-        total += s->value();
-        opt = total;
-    }
+///
+/// \brief  Show the totals of one column, and the grand total, as held by a score sheet.
+/// \param column   Zero-based index of the column whose totals to show.
+/// \param sheet    The sheet whose totals to show.
+///
+void MainWindow::preview_totals(size_t column, const ScoreSheet &sheet)
+{
+    const std::array<ScoreColumn *, GameEngine::column_count>   columns{_column_single, _column_double, _column_triple};
 
-    if (d->has_score())
     {
-        total += d->value();
-        opt = total;
+        const auto  transaction{score_transaction()};
+
+        columns[column]->show_totals(sheet);
     }
+    update_grand_total(sheet);
+}
 
-    if (t->has_score())
+void MainWindow::update_roll_button()
+{
+    _btn_roll->setText(tr("Roll! (%1 left)").arg(_game.rolls_left()));
+}
+
+///
+/// \brief  Find the score sheet cell a Score widget represents.
+/// \param score    Pointer to a Score widget.
+/// \return The cell's column and category, or an empty \c std::optional if
+///         the widget is not a scoring cell.
+///
+std::optional<MainWindow::Cell> MainWindow::find_cell(const Score *score) const
+{
+    for (size_t c{0}; c < _category_rows.size(); ++c)
     {
-        total += t->value();
-        opt = total;
+        const auto [s, d, t] = _category_rows[c]->get_scores();
+        const std::array<const Score *, GameEngine::column_count>   cells{s, d, t};
+
+        for (size_t column{0}; column < cells.size(); ++column)
+            if (cells[column] == score)
+                return Cell{column, static_cast<Category>(c)};
     }
 
-    _grand_total->total(opt);
+    return std::nullopt;
+}
+
+int MainWindow::get_score_value(const Score *score)
+{
+    const auto  cell{find_cell(score)};
+
+    if (!cell)
+        return 0;
+
+    return ScoreTable::score(ScoreTable::index(_game.dice()), cell->category);
+}
+
+void MainWindow::show_high_scores_list()
+{
+    HighScoresDialog    dlg{_config, this};
+
+    dlg.exec();
+}
+
+void MainWindow::update_grand_total()
+{
+    update_grand_total(_game.sheet());
+}
+
+void MainWindow::update_grand_total(const ScoreSheet &sheet)
+{
+    _grand_total->total(sheet.is_empty() ? std::nullopt : std::optional<int>{sheet.grand_total()});
 }
 
 
@@ -431,12 +605,16 @@ void MainWindow::update_grand_total(ScoreRow *row)
 //
 void MainWindow::score_entered(Score *score)
 {
-    if (!score->has_score() && _rolls_left < 3)
+    const auto  cell{find_cell(score)};
+
+    if (cell && _game.can_score(cell->column, cell->category))
     {
-        //_current_score_widget = score;
-        void die_0_clicked();
+        const auto  value{get_score_value(score)};
+        ScoreSheet  preview{_game.sheet()};
 
-        score->preview_score(get_score_value(score));
+        preview.set(cell->column, cell->category, value);
+        score->preview_score(value);
+        preview_totals(cell->column, preview);
     }
 }
 
@@ -444,115 +622,168 @@ void MainWindow::score_exited(Score *score)
 {
     if (!score->has_score() || score->previewing())
     {
-        //_current_score_widget = nullptr;
+        const auto  cell{find_cell(score)};
+
         score->reset();
+        if (cell)
+            preview_totals(cell->column, _game.sheet());
     }
 }
 
 void MainWindow::score_clicked(Score *score)
 {
-    if ((!score->has_score() || score->previewing()) && _rolls_left < 3)
+    const auto  cell{find_cell(score)};
+
+    _dice.finish();
+
+    if (cell && _game.score(cell->column, cell->category))
     {
-        if (_current_score_widget)
-            _current_score_widget->reset();
-        _current_score_widget = score;
-        score->set(get_score_value(score));
-        if (--_plays_left == 0)
+        _journal->record(Journal::Kind::Score, _game,
+                         static_cast<std::uint8_t>(cell->column * category_count + static_cast<size_t>(cell->category)));
+        if (_game.game_over())
         {
+            show_sheet();
             end_game();
         }
         else
         {
-            for (auto d : _dice_chk)
-                d->setChecked(false);
-            _btn_roll->setEnabled(true);
-            _undo_rolls_left = _rolls_left;
-            _rolls_left = _max_rolls;
-            enable_undo(true);
-            update_roll_button();
+            show_game();
+            autosave();
         }
     }
 }
 
-void MainWindow::enable_undo(bool enabled)
-{
-    ui->action_Undo->setEnabled(enabled);
-}
-
 ///
-/// \brief  Slot for handling when a ScoreRow changes.
-/// \param row  Pointer to the row that changed.
+/// \brief  Enable the Undo and Redo actions when the engine has steps to undo or redo.
 ///
-/// This slot should only be attached to the row holding the three final column scores.
-///
-void MainWindow::row_changed(ScoreRow *row)
+void MainWindow::update_undo_actions()
 {
-    update_grand_total(row);
+    ui->action_Undo->setEnabled(_game.can_undo());
+    ui->action_Redo->setEnabled(_game.can_redo());
 }
 
 void MainWindow::die_0_clicked()
 {
-    if (_rolls_left < _max_rolls)
+    if (_game.has_rolled())
         _dice_chk[0]->toggle();
 }
 void MainWindow::die_1_clicked()
 {
-    if (_rolls_left < _max_rolls)
+    if (_game.has_rolled())
         _dice_chk[1]->toggle();
 }
 void MainWindow::die_2_clicked()
 {
-    if (_rolls_left < _max_rolls)
+    if (_game.has_rolled())
         _dice_chk[2]->toggle();
 }
 void MainWindow::die_3_clicked()
 {
-    if (_rolls_left < _max_rolls)
+    if (_game.has_rolled())
         _dice_chk[3]->toggle();
 }
 void MainWindow::die_4_clicked()
 {
-    if (_rolls_left < _max_rolls)
+    if (_game.has_rolled())
         _dice_chk[4]->toggle();
 }
 
+///
+/// \brief  Keep or release a die, journalling the change.
+/// \param ndx  Zero-based index of the die.
+/// \param kept true to keep the die, false to release it.
+///
+void MainWindow::keep_die(size_t ndx, bool kept)
+{
+    const auto  mask{_game.dice().keep_mask()};
+
+    _game.keep(ndx, kept);
+    if (_game.dice().keep_mask() != mask)
+        _journal->record(Journal::Kind::Keep, _game);
+    update_undo_actions();
+}
+
 void MainWindow::keep_0_toggled(bool checked)
 {
-    _dice.select(0, checked);
+    keep_die(0, checked);
 }
 void MainWindow::keep_1_toggled(bool checked)
 {
-    _dice.select(1, checked);
+    keep_die(1, checked);
 }
 void MainWindow::keep_2_toggled(bool checked)
 {
-    _dice.select(2, checked);
+    keep_die(2, checked);
 }
 void MainWindow::keep_3_toggled(bool checked)
 {
-    _dice.select(3, checked);
+    keep_die(3, checked);
 }
 void MainWindow::keep_4_toggled(bool checked)
 {
-    _dice.select(4, checked);
+    keep_die(4, checked);
 }
 
 void MainWindow::die_changed(int index, int value)
 {
-    _dice_btn[index]->setIcon(*_dice_pix[value - 1]);
-    _dice_btn[index]->repaint();
+    _dice_btn[index]->setIcon(_sprites.icon(value, devicePixelRatioF()));
+}
+
+///
+/// \brief  Slot for showing all the dice at once, when rolls are not animated.
+///
+void MainWindow::dice_changed()
+{
+    const auto &dice{_dice.packed()};
+
+    for (size_t i{0}; i < _dice_btn.size(); ++i)
+        _dice_btn[i]->setIcon(_sprites.icon(dice.face(i), devicePixelRatioF()));
 }
 
 void MainWindow::roll_clicked(bool checked)
 {
+    _dice.finish();
+    clear_keep_hint();
     for (auto k : _dice_chk)
         k->setEnabled(true);
-    _dice.roll();
-    if (--_rolls_left == 0)
+    if (!_game.can_roll())
+        return;
+    _dice.roll(_game.roll());
+    _journal->record(Journal::Kind::Roll, _game);
+    if (!_game.can_roll())
         _btn_roll->setEnabled(false);
     update_roll_button();
-    _current_score_widget = nullptr;
-    enable_undo(false);
+    update_undo_actions();
+}
+
+///
+/// \brief  Slot for handling when the dice come to rest after a roll.
+///
+void MainWindow::roll_finished()
+{
+    update_keep_hint();
+}
+
+///
+/// \brief  Slot for taking over the strategy computed by the background thread.
+///
+void MainWindow::advisor_solved()
+{
+    _advisor = std::move(_solved_advisor);
+    _advisor_thread->deleteLater();
+    _advisor_thread = nullptr;
+    update_keep_hint();
+}
+
+///
+/// \brief  Slot for reporting a configuration save that failed.
+/// \param ok       true if the configuration was saved.
+/// \param error    A description of the failure.
+///
+void MainWindow::config_saved(bool ok, const QString &error)
+{
+    if (!ok)
+        QMessageBox::warning(this, "TripleYtz", tr("Your settings could not be saved.\n%1").arg(error));
 }
 
 void MainWindow::on_action_New_game_triggered()
@@ -574,15 +805,42 @@ void MainWindow::on_action_High_Scores_triggered()
 
 void MainWindow::on_action_Undo_triggered()
 {
-    // This should cover the basics of undo.
-    // More to come once Yahtzee bonus/wildcard code is in place.
-    if (_current_score_widget)
+    if (_game.undo())
     {
-        _current_score_widget->reset();
-        _current_score_widget = nullptr;
-        _rolls_left = _undo_rolls_left;
-        ++_plays_left;
-        update_roll_button();
-        enable_undo(false);
+        _journal->record(Journal::Kind::Undo, _game);
+        show_game();
     }
 }
+
+void MainWindow::on_action_Redo_triggered()
+{
+    if (_game.redo())
+    {
+        _journal->record(Journal::Kind::Redo, _game);
+        show_game();
+    }
+}
+
+///
+/// \brief  Turn turbo mode on or off.
+/// \param enabled  true to have the dice come to rest as soon as they are rolled.
+///
+void MainWindow::turbo(bool enabled)
+{
+    ui->action_Turbo->setChecked(enabled);
+}
+
+void MainWindow::on_action_Turbo_toggled(bool checked)
+{
+    _dice.animated(!checked);
+    if (checked)
+        _dice.finish();
+}
+
+void MainWindow::on_action_Keep_Hints_toggled(bool checked)
+{
+    if (checked)
+        update_keep_hint();
+    else
+        clear_keep_hint();
+}
@@ -28,13 +28,23 @@ QT_END_NAMESPACE
 
 
 #include <QCheckBox>
-#include <QPixmap>
 #include <QPushButton>
+#include <QThread>
+#include <QThreadPool>
 
 #include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
 
 #include "config.h"
 #include "dice.h"
+#include "dicesprites.h"
+#include "facegenerator.h"
+#include "gameengine.h"
+#include "gamescorer.h"
+#include "journal.h"
+#include "keepadvisor.h"
 #include "score.h"
 #include "scorecolumn.h"
 #include "scorerow.h"
@@ -45,23 +55,47 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(Config &config, QWidget *parent = nullptr);
+    MainWindow(Config &config, const QString &data_path, QWidget *parent = nullptr);
     ~MainWindow();
 
+    void replay(std::uint64_t seed, std::uint64_t game_id, FaceGenerator::Engine engine);
+    void turbo(bool enabled);
+
 private:
+    ///
+    /// \brief Identifies a scoring cell on the score sheet.
+    ///
+    struct Cell
+    {
+        size_t      column;
+        Category    category;
+    };
+
     void new_game();
+    void show_game();
+    void show_sheet();
+    ScoreTransaction score_transaction();
     void end_game();
     void update_roll_button();
+    std::optional<Cell> find_cell(const Score *score) const;
     int get_score_value(const Score *score);
     void show_high_scores_list();
-    void update_grand_total(ScoreRow *row);
-    void enable_undo(bool enabled);
+    void update_grand_total();
+    void update_grand_total(const ScoreSheet &sheet);
+    void preview_totals(size_t column, const ScoreSheet &sheet);
+    void update_undo_actions();
+    void load_advisor(const QString &data_path);
+    void resume_game();
+    void autosave();
+    void start_journal(const QString &data_path);
+    void keep_die(size_t ndx, bool kept);
+    void update_keep_hint();
+    void clear_keep_hint();
 
 public slots:
     void score_entered(Score *score);
     void score_exited(Score *score);
     void score_clicked(Score *score);
-    void row_changed(ScoreRow *row);
     void die_0_clicked();
     void die_1_clicked();
     void die_2_clicked();
@@ -73,7 +107,11 @@ public slots:
     void keep_3_toggled(bool checked);
     void keep_4_toggled(bool checked);
     void die_changed(int index, int value);
+    void dice_changed();
     void roll_clicked(bool checked);
+    void roll_finished();
+    void advisor_solved();
+    void config_saved(bool ok, const QString &error);
 
 private slots:
     void on_action_New_game_triggered();
@@ -81,13 +119,14 @@ private slots:
     void on_action_High_Scores_triggered();
 
     void on_action_Undo_triggered();
+    void on_action_Redo_triggered();
+    void on_action_Keep_Hints_toggled(bool checked);
+    void on_action_Turbo_toggled(bool checked);
 
 private:
-    static constexpr int    _max_rolls{3};
-    static constexpr int    _max_plays{39};
-
     Ui::MainWindow *ui;
 
+    GameEngine      _game;
     Dice            _dice;
 
     ScoreRow       *_aces;
@@ -114,20 +153,26 @@ private:
     ScoreRow       *_total;         //TODO: This sould be a separate type, uncolored, for singled/doubled/tripled scores
     GrandTotalRow  *_grand_total;
 
-    std::array<QPixmap *, 6>        _dice_pix;
+    std::array<ScoreRow *, category_count>  _category_rows;
+
+    DiceSprites                     _sprites;
     std::array<QPushButton *, 5>    _dice_btn;
     std::array<QCheckBox *, 5>      _dice_chk;
 
     QPushButton    *_btn_roll;
-    int             _rolls_left{_max_rolls};
-    int             _undo_rolls_left{_max_rolls};
-    int             _plays_left{_max_plays};
 
     ScoreColumn    *_column_single{nullptr};
     ScoreColumn    *_column_double{nullptr};
     ScoreColumn    *_column_triple{nullptr};
 
-    Score          *_current_score_widget{nullptr};
+    std::unique_ptr<KeepAdvisor>    _advisor;
+    std::unique_ptr<KeepAdvisor>    _solved_advisor;    // handed over from _advisor_thread when it finishes
+    QThread                        *_advisor_thread{nullptr};
+
+    QString                         _save_path;
+    QThreadPool                     _save_pool;         // a single thread, so games are saved in order
+
+    std::unique_ptr<Journal>        _journal;
 
     Config         &_config;
 };
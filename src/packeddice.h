@@ -0,0 +1,218 @@
+#ifndef PACKEDDICE_H
+#define PACKEDDICE_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+///
+/// \brief A compact, trivially copyable representation of five dice.
+///
+/// The face of each die occupies three bits of a 15-bit encoding, and a
+/// 5-bit mask records which dice are kept between rolls. The number of dice
+/// showing each face is kept up to date as faces change, so scoring a roll
+/// never has to count the dice again.
+///
+class PackedDice
+{
+public:
+    ///
+    /// \brief  Construct a PackedDice object showing one through five, with no dice kept.
+    ///
+    constexpr PackedDice() noexcept
+    {
+        for (size_t i{0}; i < size(); ++i)
+            face(i, static_cast<int>(i) + 1);
+    }
+
+    ///
+    /// \brief  Construct a PackedDice object from its 15-bit face encoding.
+    /// \param encoding The encoding of the faces, as returned by \c encoding().
+    /// \param keep_mask    The mask of kept dice.
+    ///
+    /// The encoding must be valid. Use \c from_encoding for encodings read from files.
+    explicit constexpr PackedDice(std::uint16_t encoding, std::uint8_t keep_mask = 0) noexcept
+    {
+        assert(is_valid(encoding));
+        for (size_t i{0}; i < size(); ++i)
+            face(i, (encoding >> (3 * i)) & 0x7);
+        _keep = keep_mask & 0x1F;
+    }
+
+    ///
+    /// \brief  Construct a PackedDice object from an encoding that may not be valid.
+    /// \param encoding     The encoding of the faces, as returned by \c encoding().
+    /// \param keep_mask    The mask of kept dice.
+    /// \return The dice, or nothing if the encoding is not valid.
+    ///
+    static constexpr std::optional<PackedDice> from_encoding(std::uint16_t encoding, std::uint8_t keep_mask = 0) noexcept
+    {
+        if (!is_valid(encoding))
+            return std::nullopt;
+
+        return PackedDice{encoding, keep_mask};
+    }
+
+    ///
+    /// \brief  Determine whether a 15-bit encoding gives each die a face of one through six.
+    ///
+    static constexpr bool is_valid(std::uint16_t encoding) noexcept
+    {
+        if (encoding >> (3 * size()))
+            return false;
+        for (size_t i{0}; i < size(); ++i)
+        {
+            const int   face{(encoding >> (3 * i)) & 0x7};
+
+            if (face < 1 || face > 6)
+                return false;
+        }
+
+        return true;
+    }
+
+    ///
+    /// \brief  Retrieve the number of dice
+    /// \return The number of dice
+    ///
+    static constexpr size_t size() noexcept
+    {
+        return 5;
+    }
+
+    ///
+    /// \brief  Retrieve the face value of a single die.
+    /// \param ndx  Zero-based index of the die.
+    /// \return The face value, one through six.
+    ///
+    constexpr int face(size_t ndx) const noexcept
+    {
+        return (_faces >> (3 * ndx)) & 0x7;
+    }
+    ///
+    /// \brief  Set the face value of a single die.
+    /// \param ndx      Zero-based index of the die.
+    /// \param value    The new face value, one through six.
+    ///
+    constexpr void face(size_t ndx, int value) noexcept
+    {
+        const int   old{face(ndx)};
+
+        assert(value >= 1 && value <= 6);
+        if (old)
+            _counts -= 1u << (4 * (old - 1));
+        _counts += 1u << (4 * (value - 1));
+        _faces = static_cast<std::uint16_t>((_faces & ~(0x7u << (3 * ndx))) | (static_cast<unsigned>(value) << (3 * ndx)));
+    }
+
+    ///
+    /// \brief  Retrieve the face values of all five dice.
+    /// \return A \c std::array of five integers representing the face value of each die.
+    ///
+    constexpr std::array<int, 5> faces() const noexcept
+    {
+        return {face(0), face(1), face(2), face(3), face(4)};
+    }
+
+    ///
+    /// \brief  Retrieve the 15-bit face encoding, three bits per die.
+    ///
+    constexpr std::uint16_t encoding() const noexcept
+    {
+        return _faces;
+    }
+
+    ///
+    /// \brief  Retrieve the number of dice showing a given face.
+    /// \param value    The face value, one through six.
+    ///
+    constexpr int pip_count(int value) const noexcept
+    {
+        return (_counts >> (4 * (value - 1))) & 0xF;
+    }
+    ///
+    /// \brief  Retrieve the number of dice showing each face.
+    /// \return The number of dice showing one through six pips.
+    ///
+    constexpr std::array<int, 6> pip_counts() const noexcept
+    {
+        return {pip_count(1), pip_count(2), pip_count(3), pip_count(4), pip_count(5), pip_count(6)};
+    }
+
+    ///
+    /// \brief  Determine whether a die is kept.
+    /// \param ndx  Zero-based index of the die to be checked
+    ///
+    constexpr bool is_kept(size_t ndx) const noexcept
+    {
+        return (_keep >> ndx) & 1;
+    }
+    ///
+    /// \brief  Mark a single die as kept.
+    /// \param ndx  Zero-based index of the die.
+    /// \param kept true to keep, false to release.
+    ///
+    constexpr void keep(size_t ndx, bool kept) noexcept
+    {
+        if (kept)
+            _keep = static_cast<std::uint8_t>(_keep | (1u << ndx));
+        else
+            _keep = static_cast<std::uint8_t>(_keep & ~(1u << ndx));
+    }
+
+    ///
+    /// \brief  Retrieve the mask of kept dice. Bit \c n is set when die \c n is kept.
+    ///
+    constexpr std::uint8_t keep_mask() const noexcept
+    {
+        return _keep;
+    }
+    ///
+    /// \brief  Set the mask of kept dice. Bit \c n is set when die \c n is kept.
+    ///
+    constexpr void keep_mask(std::uint8_t mask) noexcept
+    {
+        _keep = mask & 0x1F;
+    }
+
+    friend constexpr bool operator==(const PackedDice &lhs, const PackedDice &rhs) noexcept
+    {
+        return lhs._faces == rhs._faces && lhs._keep == rhs._keep;
+    }
+    friend constexpr bool operator!=(const PackedDice &lhs, const PackedDice &rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    std::uint16_t   _faces{0};
+    std::uint8_t    _keep{0};
+    std::uint32_t   _counts{0};     // four bits per face value
+};
+
+static_assert(std::is_trivially_copyable_v<PackedDice>);
+static_assert(sizeof(PackedDice) == 8);
+
+#endif // PACKEDDICE_H
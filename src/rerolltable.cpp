@@ -0,0 +1,255 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "rerolltable.h"
+#include "scoretable.h"
+
+namespace {
+constexpr std::array<int, 7>    offsets{0, 1, 7, 28, 84, 210, 462};     // first keep of each size
+
+///
+/// \brief The tables behind \c RerollTable.
+///
+struct Tables
+{
+    std::array<std::array<int, 6>, RerollTable::keep_count>             counts{};
+    std::array<std::uint8_t, RerollTable::keep_count>                   sizes{};
+    std::array<std::array<std::int16_t, 6>, RerollTable::keep_count>    children{};     // keep plus one die of each face
+    std::array<std::uint16_t, RerollTable::keep_count + 1>              first_outcome{};
+    std::array<RerollTable::Outcome, RerollTable::outcome_count>        outcomes{};
+    std::array<std::array<std::int16_t, 32>, ScoreTable::size>          by_mask{};      // keep for each mask of a sorted roll
+    std::array<std::array<std::int16_t, 32>, ScoreTable::size>          distinct{};     // distinct keeps of each roll
+    std::array<std::uint8_t, ScoreTable::size>                          distinct_count{};
+
+    Tables();
+};
+
+int keep_of(const std::array<int, 6> &counts) noexcept
+{
+    int size{0};
+
+    for (const auto c : counts)
+        size += c;
+
+    return offsets[size] + scoretable_detail::rank(counts);
+}
+
+Tables::Tables()
+{
+    std::array<int, 6>  c{};
+
+    // Enumerate every multiset of up to five dice as a vector of counts.
+    for (c[0] = 0; c[0] <= 5; ++c[0])
+    for (c[1] = 0; c[0] + c[1] <= 5; ++c[1])
+    for (c[2] = 0; c[0] + c[1] + c[2] <= 5; ++c[2])
+    for (c[3] = 0; c[0] + c[1] + c[2] + c[3] <= 5; ++c[3])
+    for (c[4] = 0; c[0] + c[1] + c[2] + c[3] + c[4] <= 5; ++c[4])
+    for (c[5] = 0; c[0] + c[1] + c[2] + c[3] + c[4] + c[5] <= 5; ++c[5])
+    {
+        const int   keep{keep_of(c)};
+        const int   size{c[0] + c[1] + c[2] + c[3] + c[4] + c[5]};
+
+        counts[keep] = c;
+        sizes[keep] = static_cast<std::uint8_t>(size);
+        for (int f{0}; f < 6; ++f)
+        {
+            if (size < 5)
+            {
+                ++c[f];
+                children[keep][f] = static_cast<std::int16_t>(keep_of(c));
+                --c[f];
+            }
+            else
+            {
+                children[keep][f] = -1;
+            }
+        }
+    }
+
+    // The outcomes of a keep are found by adding one die at a time, merging
+    // the weights of orderings that reach the same roll. Keeps are visited in
+    // index order so each keep's outcomes are contiguous.
+    size_t  n{0};
+
+    for (size_t keep{0}; keep < RerollTable::keep_count; ++keep)
+    {
+        std::array<std::uint16_t, RerollTable::keep_count>  weights{};
+        std::array<std::uint16_t, RerollTable::keep_count>  next{};
+        const int   rerolled{5 - sizes[keep]};
+        int         denominator{1};
+
+        weights[keep] = 1;
+        for (int d{0}; d < rerolled; ++d)
+        {
+            next.fill(0);
+            for (size_t k{0}; k < weights.size(); ++k)
+                if (weights[k])
+                    for (const auto child : children[k])
+                        next[child] = static_cast<std::uint16_t>(next[child] + weights[k]);
+            weights = next;
+            denominator *= 6;
+        }
+
+        first_outcome[keep] = static_cast<std::uint16_t>(n);
+        for (size_t k{static_cast<size_t>(offsets[5])}; k < weights.size(); ++k)
+            if (weights[k])
+            {
+                assert(n < RerollTable::outcome_count);
+                outcomes[n++] = RerollTable::Outcome{static_cast<std::uint16_t>(k - offsets[5]),
+                                                     weights[k],
+                                                     static_cast<float>(weights[k]) / static_cast<float>(denominator)};
+            }
+    }
+    assert(n == RerollTable::outcome_count);
+    first_outcome[RerollTable::keep_count] = static_cast<std::uint16_t>(n);
+
+    for (int roll{0}; roll < static_cast<int>(ScoreTable::size); ++roll)
+    {
+        const auto         &roll_counts{ScoreTable::pip_counts(roll)};
+        std::array<int, 5>  faces{};
+        size_t              m{0};
+
+        for (int f{0}; f < 6; ++f)
+            for (int k{0}; k < roll_counts[f]; ++k)
+                faces[m++] = f;
+
+        for (unsigned mask{0}; mask < 32; ++mask)
+        {
+            std::array<int, 6>  kept{0, 0, 0, 0, 0, 0};
+
+            for (size_t d{0}; d < faces.size(); ++d)
+                if (mask & (1u << d))
+                    ++kept[faces[d]];
+
+            const auto  keep{static_cast<std::int16_t>(keep_of(kept))};
+            auto       &list{distinct[roll]};
+            auto       &count{distinct_count[roll]};
+
+            by_mask[roll][mask] = keep;
+            if (std::find(list.begin(), list.begin() + count, keep) == list.begin() + count)
+                list[count++] = keep;
+        }
+    }
+}
+
+const Tables &tables()
+{
+    static const Tables instance;
+
+    return instance;
+}
+}   // anonymous namespace
+
+///
+/// \brief RerollTable::outcomes    Retrieve the rolls a keep can lead to.
+/// \param keep The index of the keep.
+/// \return The outcomes of rerolling the dice not in the keep, ordered by roll
+///         index. Their probabilities sum to one.
+///
+RerollTable::Range<RerollTable::Outcome> RerollTable::outcomes(int keep) noexcept
+{
+    const auto &t{tables()};
+
+    return {t.outcomes.data() + t.first_outcome[keep], t.outcomes.data() + t.first_outcome[keep + 1]};
+}
+
+///
+/// \brief RerollTable::keeps   Retrieve the distinct keeps of a roll.
+/// \param roll The index of the roll.
+/// \return The indexes of the keeps the 32 masks of the roll lead to, without duplicates.
+///
+RerollTable::Range<std::int16_t> RerollTable::keeps(int roll) noexcept
+{
+    const auto &t{tables()};
+    const auto *first{t.distinct[roll].data()};
+
+    return {first, first + t.distinct_count[roll]};
+}
+
+///
+/// \brief RerollTable::children    Retrieve the keeps with one more die than a keep.
+/// \param keep The index of the keep.
+/// \return The index of the keep plus one die showing each face, or -1 for a keep of five dice.
+///
+const std::array<std::int16_t, 6> &RerollTable::children(int keep) noexcept
+{
+    return tables().children[keep];
+}
+
+///
+/// \brief RerollTable::keep_index  Find the keep holding the given dice.
+/// \param counts   The number of kept dice showing each face, five at most in all.
+/// \return The index of the keep.
+///
+int RerollTable::keep_index(const std::array<int, 6> &counts) noexcept
+{
+    return keep_of(counts);
+}
+
+///
+/// \brief RerollTable::keep_index  Find the keep chosen by a mask over a sorted roll.
+/// \param roll The index of the roll, with its dice in ascending order.
+/// \param mask The mask of kept dice. Bit \c n is set when the n-th lowest die is kept.
+/// \return The index of the keep.
+///
+int RerollTable::keep_index(int roll, std::uint8_t mask) noexcept
+{
+    return tables().by_mask[roll][mask & 0x1F];
+}
+
+///
+/// \brief RerollTable::keep_index  Find the keep chosen by a mask over a set of dice.
+/// \param dice The dice showing.
+/// \param mask The mask of kept dice. Bit \c n is set when die \c n is kept.
+/// \return The index of the keep.
+///
+int RerollTable::keep_index(const PackedDice &dice, std::uint8_t mask) noexcept
+{
+    std::array<int, 6>  kept{0, 0, 0, 0, 0, 0};
+
+    for (size_t d{0}; d < dice.size(); ++d)
+        if (mask & (1u << d))
+            ++kept[dice.face(d) - 1];
+
+    return keep_of(kept);
+}
+
+///
+/// \brief RerollTable::keep_size   Retrieve the number of dice in a keep.
+/// \param keep The index of the keep.
+///
+int RerollTable::keep_size(int keep) noexcept
+{
+    return tables().sizes[keep];
+}
+
+///
+/// \brief RerollTable::keep_counts Retrieve the number of dice of each face in a keep.
+/// \param keep The index of the keep.
+///
+const std::array<int, 6> &RerollTable::keep_counts(int keep) noexcept
+{
+    return tables().counts[keep];
+}
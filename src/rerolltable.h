@@ -0,0 +1,100 @@
+#ifndef REROLLTABLE_H
+#define REROLLTABLE_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "packeddice.h"
+#include "scoretable.h"
+
+///
+/// \brief Exact probabilities of the rolls reached by rerolling dice.
+///
+/// A keep is the multiset of dice held back before a reroll. The 32 keep masks
+/// of a roll collapse to at most 32 distinct keeps, and there are 462 distinct
+/// keeps of zero to five dice in all. Keeps are indexed by size and then by
+/// rank within their size, so the keeps of five dice occupy the last 252
+/// indexes in \c ScoreTable order.
+///
+/// For each keep the table holds the sparse distribution of the rolls that
+/// rerolling the other dice can lead to, stored contiguously with the
+/// outcomes of all keeps. All lookups are into tables built once, and the
+/// ranges returned refer into those tables, so iterating them never allocates.
+///
+class RerollTable
+{
+public:
+    ///
+    /// \brief The number of distinct keeps of zero to five dice.
+    ///
+    static constexpr size_t keep_count{462};
+
+    ///
+    /// \brief The total number of outcomes over all keeps.
+    ///
+    static constexpr size_t outcome_count{4368};
+
+    ///
+    /// \brief A roll reachable from a keep, and the chance of reaching it.
+    ///
+    struct Outcome
+    {
+        std::uint16_t   roll;           // index of the roll, as in ScoreTable
+        std::uint16_t   weight;         // number of the 6^n rerolls of n dice leading to the roll
+        float           probability;    // weight / 6^n
+    };
+
+    ///
+    /// \brief A read-only view of a contiguous run of table entries.
+    ///
+    template<typename T>
+    class Range
+    {
+    public:
+        constexpr Range(const T *first, const T *last) noexcept
+          : _first{first}
+          , _last{last}
+        {}
+
+        constexpr const T *begin() const noexcept   { return _first; }
+        constexpr const T *end() const noexcept     { return _last; }
+        constexpr size_t size() const noexcept      { return static_cast<size_t>(_last - _first); }
+        constexpr const T &operator[](size_t ndx) const noexcept { return _first[ndx]; }
+
+    private:
+        const T    *_first;
+        const T    *_last;
+    };
+
+    static Range<Outcome> outcomes(int keep) noexcept;
+    static Range<std::int16_t> keeps(int roll) noexcept;
+    static const std::array<std::int16_t, 6> &children(int keep) noexcept;
+
+    static int keep_index(const std::array<int, 6> &counts) noexcept;
+    static int keep_index(int roll, std::uint8_t mask) noexcept;
+    static int keep_index(const PackedDice &dice, std::uint8_t mask) noexcept;
+    static int keep_size(int keep) noexcept;
+    static const std::array<int, 6> &keep_counts(int keep) noexcept;
+};
+
+#endif // REROLLTABLE_H
@@ -0,0 +1,245 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include "gameengine.h"
+#include "savedgame.h"
+
+namespace {
+constexpr char          Magic[8]{'T', 'Y', 'T', 'Z', 'G', 'A', 'M', 'E'};
+constexpr std::uint32_t ByteOrder{0x01020304};
+
+///
+/// \brief The fixed header at the start of every saved game.
+///
+struct Header
+{
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   byte_order;         // detects games saved on a machine of different endianness
+    std::uint64_t   seed;
+    std::uint64_t   game_id;
+    std::uint8_t    engine;
+    std::int8_t     rolls_left;
+    std::int8_t     plays_left;
+    std::uint8_t    keep_mask;
+    std::uint16_t   faces;              // encoding of the dice
+    std::uint16_t   drawn;              // number of faces drawn from the generator
+    std::int8_t     cells[GameEngine::column_count][category_count];    // -1 marks an empty cell
+    std::uint8_t    reserved;
+    std::uint16_t   step_count;
+    std::uint16_t   position;           // the number of steps not undone
+};
+
+static_assert(sizeof(Header) == 88);
+
+constexpr int max_drawn{GameEngine::max_plays * GameEngine::max_rolls * static_cast<int>(PackedDice::size())};
+}   // anonymous namespace
+
+///
+/// \brief SavedGame::SavedGame Encode the state of a game.
+/// \param game The game.
+///
+SavedGame::SavedGame(const GameEngine &game)
+{
+    Header          header{};
+    const auto     &sheet{game.sheet()};
+    const size_t    steps_size{game._history.size() * sizeof(GameEngine::Step)};
+
+    std::copy(std::begin(Magic), std::end(Magic), header.magic);
+    header.version = version;
+    header.byte_order = ByteOrder;
+    header.seed = game._seed;
+    header.game_id = game._game_id;
+    header.engine = static_cast<std::uint8_t>(game.engine());
+    header.rolls_left = static_cast<std::int8_t>(game._rolls_left);
+    header.plays_left = static_cast<std::int8_t>(game._plays_left);
+    header.keep_mask = game._dice.keep_mask();
+    header.faces = game._dice.encoding();
+    header.drawn = game._drawn;
+    for (size_t column{0}; column < GameEngine::column_count; ++column)
+        for (size_t c{0}; c < category_count; ++c)
+            header.cells[column][c] = static_cast<std::int8_t>(sheet.cell(column, static_cast<Category>(c)).value_or(-1));
+    header.step_count = static_cast<std::uint16_t>(game._history.size());
+    header.position = static_cast<std::uint16_t>(game._position);
+
+    _bytes.resize(sizeof(header) + steps_size);
+    std::memcpy(_bytes.data(), &header, sizeof(header));
+    if (steps_size)
+        std::memcpy(_bytes.data() + sizeof(header), game._history.data(), steps_size);
+}
+
+///
+/// \brief SavedGame::restore   Restore a game to the encoded state.
+/// \param game Receives the game.
+/// \return true if the game was restored, false if the encoding is not a
+///         saved game of this version or does not hold a valid state. The
+///         game is unchanged on failure.
+///
+bool SavedGame::restore(GameEngine &game) const
+{
+    Header  header;
+
+    if (_bytes.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, _bytes.data(), sizeof(header));
+
+    const size_t    steps_size{size_t{header.step_count} * sizeof(GameEngine::Step)};
+    int             filled{0};
+
+    if (   !std::equal(std::begin(Magic), std::end(Magic), header.magic)
+        || header.version != version
+        || header.byte_order != ByteOrder
+        || header.engine > static_cast<std::uint8_t>(FaceGenerator::Engine::Philox)
+        || header.rolls_left < 0 || header.rolls_left > GameEngine::max_rolls
+        || header.plays_left < 0 || header.plays_left > GameEngine::max_plays
+        || header.keep_mask > 0x1F
+        || !PackedDice::is_valid(header.faces)
+        || header.drawn > max_drawn
+        || header.position > header.step_count
+        || _bytes.size() != sizeof(header) + steps_size)
+        return false;
+
+    GameEngine  restored{header.seed, static_cast<FaceGenerator::Engine>(header.engine)};
+
+    restored.new_game(header.seed, header.game_id);
+    for (size_t column{0}; column < GameEngine::column_count; ++column)
+        for (size_t c{0}; c < category_count; ++c)
+        {
+            const int   score{header.cells[column][c]};
+
+            if (score > 50)
+                return false;
+            if (score >= 0)
+            {
+                restored._sheet.set(column, static_cast<Category>(c), score);
+                ++filled;
+            }
+        }
+    if (filled + header.plays_left != GameEngine::max_plays)
+        return false;
+
+    restored._dice = PackedDice{header.faces, header.keep_mask};
+    restored._rolls_left = header.rolls_left;
+    restored._plays_left = header.plays_left;
+    restored._drawn = header.drawn;
+    restored._history.resize(header.step_count);
+    if (steps_size)
+        std::memcpy(restored._history.data(), _bytes.data() + sizeof(header), steps_size);
+    const auto  valid_step{[](const GameEngine::Step &step)
+                           {
+                               using Action = GameEngine::Step::Action;
+
+                               const bool  valid_action{   step.action == Action::Roll
+                                                        || (step.action == Action::Keep && step.argument <= 0x1F)
+                                                        || (   step.action == Action::Score
+                                                            && step.argument < GameEngine::column_count * category_count)};
+
+                               return    valid_action
+                                      && step.keep_mask <= 0x1F
+                                      && step.rolls_left >= 0 && step.rolls_left <= GameEngine::max_rolls
+                                      && PackedDice::is_valid(step.faces)
+                                      && step.drawn <= max_drawn;
+                           }};
+
+    if (!std::all_of(restored._history.begin(), restored._history.end(), valid_step))
+        return false;
+
+    // Draw the faces once to take the generator's position before each block,
+    // so undo and redo go to any step without drawing them again.
+    std::uint16_t   last{header.drawn};
+
+    for (const auto &step : restored._history)
+        last = std::max(last, step.drawn);
+    for (int drawn{0}; drawn <= last; drawn += FaceGenerator::faces_per_draw)
+    {
+        restored._refills.push_back(restored._faces.position());
+        restored._faces.skip(FaceGenerator::faces_per_draw);
+    }
+    restored.seek(header.drawn);
+    restored._position = header.position;
+
+    game = std::move(restored);
+    return true;
+}
+
+///
+/// \brief SavedGame::read  Read a saved game from a file.
+/// \param path The location of the file.
+/// \return true if the file was read, false otherwise. The file is not checked
+///         until the game is restored.
+///
+bool SavedGame::read(const std::string &path)
+{
+    std::ifstream   file{path, std::ios::binary};
+
+    if (!file)
+        return false;
+
+    _bytes.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    return !file.bad();
+}
+
+///
+/// \brief SavedGame::write Write the saved game to a file.
+/// \param path The location of the file.
+/// \return true if the file was written, false otherwise.
+///
+/// The game is written to a temporary file that then replaces the file, so
+/// an interrupted write never leaves a damaged game behind.
+bool SavedGame::write(const std::string &path) const
+{
+    const std::string   temp{path + ".tmp"};
+
+    {
+        std::ofstream   file{temp, std::ios::binary | std::ios::trunc};
+
+        if (!file)
+            return false;
+
+        file.write(reinterpret_cast<const char *>(_bytes.data()), static_cast<std::streamsize>(_bytes.size()));
+        if (!file.flush())
+        {
+            file.close();
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+
+#if defined(_WIN32)
+    return MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(temp.c_str(), path.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,65 @@
+#ifndef SAVEDGAME_H
+#define SAVEDGAME_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class GameEngine;
+
+///
+/// \brief The complete state of a game, in a compact binary encoding.
+///
+/// The encoding is a fixed header followed by the game's history of steps.
+/// The header identifies the format and its version, and holds the master
+/// seed, game id and generator, the score sheet, the dice and the state of
+/// the turn. The dice's generator is not stored: it is restored from the
+/// seed, the game id and the number of faces drawn from it. A game takes at
+/// most a few KB, and is restored by copying rather than by parsing.
+///
+class SavedGame
+{
+public:
+    static constexpr std::uint32_t  version{1};
+
+    SavedGame() = default;
+    explicit SavedGame(const GameEngine &game);
+
+    bool restore(GameEngine &game) const;
+
+    ///
+    /// \brief  Retrieve the encoded game.
+    ///
+    const std::vector<std::uint8_t> &bytes() const noexcept
+    {
+        return _bytes;
+    }
+
+    bool read(const std::string &path);
+    bool write(const std::string &path) const;
+
+private:
+    std::vector<std::uint8_t>   _bytes;
+};
+
+#endif // SAVEDGAME_H
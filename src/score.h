@@ -79,8 +79,13 @@ public:
     /// \brief  Set the score value.
     /// \param value    The value to be set.
     ///
+    /// Setting a score to the value it already holds does nothing, so it does
+    /// not emit the \c on_changed signal.
+    ///
     void set(int value)
     {
+        if (_score == value && !_previewing)
+            return;
         _previewing = false;
         _score = value;
         update();
@@ -89,8 +94,12 @@ public:
     ///
     /// \brief  Clears the score value. The has_value function returns false after calling this function.
     ///
+    /// Clearing a score that is already clear does nothing.
+    ///
     void reset()
     {
+        if (!_score && !_previewing)
+            return;
         _score.reset();
         _previewing = false;
         update();
@@ -20,219 +20,185 @@
 * with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
 **************************************************************************/
 
-#include <QObject>
+#include <QWidget>
 
 #include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <optional>
+#include <vector>
 
 #include "score.h"
+#include "scoresheet.h"
 
-class ScoreColumn : public QObject
+///
+/// \brief Shows one column of a ScoreSheet in the column's Score widgets.
+///
+/// The column does not hold any scores itself: whenever it is refreshed it
+/// shows the cells and totals held by the sheet, which keeps them up to date.
+///
+class ScoreColumn
 {
-    Q_OBJECT
-
 public:
-    explicit ScoreColumn(int multiplier, const std::array<Score *, 20> &scores)
-      : _multiplier{multiplier}
-      , _aces{scores[0]}
-      , _twos{scores[1]}
-      , _threes{scores[2]}
-      , _fours{scores[3]}
-      , _fives{scores[4]}
-      , _sixes{scores[5]}
+    ///
+    /// \brief  Construct a ScoreColumn object.
+    /// \param sheet    The score sheet to show. It must outlive the ScoreColumn.
+    /// \param column   Zero-based index of the column within the sheet.
+    /// \param scores   The column's Score widgets, from Aces down to the column's total.
+    ///
+    ScoreColumn(const ScoreSheet &sheet, size_t column, const std::array<Score *, 20> &scores)
+      : _sheet{sheet}
+      , _column{column}
+      , _cells{scores[0], scores[1], scores[2], scores[3], scores[4], scores[5],
+               scores[9], scores[10], scores[11], scores[12], scores[13], scores[14], scores[15]}
       , _upper_sub_total{scores[6]}
       , _bonus{scores[7]}
       , _upper_total{scores[8]}
-      , _three_of_a_kind{scores[9]}
-      , _four_of_a_kind{scores[10]}
-      , _full_house{scores[11]}
-      , _small_straight{scores[12]}
-      , _large_straight{scores[13]}
-      , _yahtzee{scores[14]}
-      , _chance{scores[15]}
       , _lower_section_total{scores[16]}
       , _upper_section_total{scores[17]}
       , _combined_total{scores[18]}
       , _total{scores[19]}
-    {
-        connect(_aces, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_twos, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_threes, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_fours, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_fives, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_sixes, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_three_of_a_kind, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_four_of_a_kind, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_full_house, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_small_straight, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_large_straight, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_yahtzee, &Score::on_changed, this, &ScoreColumn::score_changed);
-        connect(_chance, &Score::on_changed, this, &ScoreColumn::score_changed);
-    }
+    {}
 
-private:
-    bool is_upper(Score *score)
+    ScoreColumn(const ScoreColumn &) = delete;
+    ScoreColumn &operator=(const ScoreColumn &) = delete;
+
+    ///
+    /// \brief  Begin a batch of changes to the column's scores.
+    ///
+    /// Until the matching call to \c end_update() the widgets are not
+    /// refreshed. Batches may be nested.
+    ///
+    void begin_update() noexcept
     {
-        return (   score == _aces
-                || score == _twos
-                || score == _threes
-                || score == _fours
-                || score == _fives
-                || score == _sixes);
+        ++_update_depth;
     }
-    bool is_lower(Score *score)
+    ///
+    /// \brief  End a batch of changes, refreshing the widgets once if the column was refreshed during it.
+    ///
+    void end_update()
     {
-        return (   score == _three_of_a_kind
-                || score == _four_of_a_kind
-                || score == _full_house
-                || score == _small_straight
-                || score == _large_straight
-                || score == _yahtzee
-                || score == _chance);
+        if (_update_depth > 0 && --_update_depth == 0 && _stale)
+            refresh();
     }
 
-private slots:
-    void score_changed(Score *score)
+    ///
+    /// \brief  Show the column's cells and totals as they are held by the score sheet.
+    ///
+    /// Within a batch of changes the widgets are refreshed when the batch ends.
+    ///
+    void refresh()
     {
-        if (is_upper(score))
+        if (_update_depth > 0)
         {
-            int     total{0};
-            int     has_score_count{0};
-
-            if (_aces->has_score())
-            {
-                total += _aces->value();
-                ++has_score_count;
-            }
-            if (_twos->has_score())
-            {
-                total += _twos->value();
-                ++has_score_count;
-            }
-            if (_threes->has_score())
-            {
-                total += _threes->value();
-                ++has_score_count;
-            }
-            if (_fours->has_score())
-            {
-                total += _fours->value();
-                ++has_score_count;
-            }
-            if (_fives->has_score())
-            {
-                total += _fives->value();
-                ++has_score_count;
-            }
-            if (_sixes->has_score())
-            {
-                total += _sixes->value();
-                ++has_score_count;
-            }
-
-            if (has_score_count)
-            {
-                _upper_sub_total->set(total);
-                if (total >= 63)
-                {
-                    _bonus->set(35);
-                    _upper_total->set(35 + total);
-                }
-                else
-                {
-                    _bonus->reset();
-                    _upper_total->set(total);
-                }
-                _upper_section_total->set(_upper_total->value());
-            }
-            else
-            {
-                _upper_sub_total->reset();
-                _bonus->reset();
-                _upper_total->reset();
-                _upper_section_total->reset();
-            }
-        }
-        else if (is_lower(score))
-        {
-            int     total{0};
-            int     has_score_count{0};
-
-            if (_three_of_a_kind->has_score())
-            {
-                total += _three_of_a_kind->value();
-                ++has_score_count;
-            }
-            if (_four_of_a_kind->has_score())
-            {
-                total += _four_of_a_kind->value();
-                ++has_score_count;
-            }
-            if (_full_house->has_score())
-            {
-                total += _full_house->value();
-                ++has_score_count;
-            }
-            if (_small_straight->has_score())
-            {
-                total += _small_straight->value();
-                ++has_score_count;
-            }
-            if (_large_straight->has_score())
-            {
-                total += _large_straight->value();
-                ++has_score_count;
-            }
-            if (_yahtzee->has_score())
-            {
-                total += _yahtzee->value();
-                ++has_score_count;
-            }
-            if (_chance->has_score())
-            {
-                total += _chance->value();
-                ++has_score_count;
-            }
-
-            if (has_score_count)
-                _lower_section_total->set(total);
-            else
-                _lower_section_total->reset();
+            _stale = true;
+            return;
         }
+        _stale = false;
 
-        if (_lower_section_total->has_score() || _upper_section_total->has_score())
-        {
-            _combined_total->set(_upper_section_total->value_or(0) + _lower_section_total->value_or(0));
-            _total->set(_combined_total->value() * _multiplier);
-        }
+        for (size_t c{0}; c < _cells.size(); ++c)
+            show(_cells[c], _sheet.cell(_column, static_cast<Category>(c)));
+
+        show_totals(_sheet);
+    }
+
+    ///
+    /// \brief  Show the column's totals as they are held by another score sheet.
+    /// \param sheet    The sheet whose totals to show, such as a copy of the
+    ///                 game's sheet with a previewed cell set.
+    ///
+    /// The cells are left alone. The next \c refresh() shows the totals held
+    /// by the column's own sheet again.
+    ///
+    void show_totals(const ScoreSheet &sheet)
+    {
+        const auto  filled{sheet.filled(_column)};
+        const auto  totals{sheet.totals(_column)};
+        const bool  has_upper{(filled & ScoreSheet::upper_mask) != 0};
+        const bool  has_lower{(filled & ~ScoreSheet::upper_mask) != 0};
+
+        show(_upper_sub_total, has_upper, totals.upper_sub_total);
+        show(_bonus, totals.bonus != 0, totals.bonus);
+        show(_upper_total, has_upper, totals.upper_total);
+        show(_upper_section_total, has_upper, totals.upper_total);
+        show(_lower_section_total, has_lower, totals.lower_total);
+        show(_combined_total, filled != 0, totals.combined_total);
+        show(_total, filled != 0, totals.total);
+    }
+
+private:
+    static void show(Score *score, std::optional<int> value)
+    {
+        if (value)
+            score->set(*value);
         else
-        {
-            _combined_total->reset();
-            _total->reset();
-        }
+            score->reset();
+    }
+    static void show(Score *score, bool has_value, int value)
+    {
+        show(score, has_value ? std::optional<int>{value} : std::nullopt);
+    }
+
+private:
+    const ScoreSheet                       &_sheet;
+    size_t                                  _column;
+    int                                     _update_depth{0};
+    bool                                    _stale{false};     // refreshed during a batch of changes
+    std::array<Score *, category_count>     _cells;
+    Score                                  *_upper_sub_total;
+    Score                                  *_bonus;
+    Score                                  *_upper_total;
+    Score                                  *_lower_section_total;
+    Score                                  *_upper_section_total;
+    Score                                  *_combined_total;
+    Score                                  *_total;
+};
+
+///
+/// \brief Groups changes to the scores of several columns into one update.
+///
+/// While a transaction is open the columns do not refresh their widgets, and
+/// the widget holding the score sheet is not repainted. When the transaction
+/// ends each column that was refreshed during it refreshes its widgets once,
+/// and the sheet is repainted once.
+///
+class ScoreTransaction
+{
+public:
+    ///
+    /// \brief  Begin a transaction.
+    /// \param sheet    Pointer to the widget holding the score sheet.
+    /// \param columns  The columns whose scores will change.
+    ///
+    ScoreTransaction(QWidget *sheet, std::initializer_list<ScoreColumn *> columns)
+      : _sheet{sheet}
+      , _columns{columns}
+      , _sheet_updates{sheet->updatesEnabled()}
+    {
+        _sheet->setUpdatesEnabled(false);
+        for (auto column : _columns)
+            column->begin_update();
+    }
+
+    ScoreTransaction(const ScoreTransaction &) = delete;
+    ScoreTransaction(ScoreTransaction &&) = delete;
+    ScoreTransaction &operator=(const ScoreTransaction &) = delete;
+    ScoreTransaction &operator=(ScoreTransaction &&) = delete;
+
+    ///
+    /// \brief  End the transaction.
+    ///
+    ~ScoreTransaction()
+    {
+        for (auto column : _columns)
+            column->end_update();
+        _sheet->setUpdatesEnabled(_sheet_updates);
     }
 
 private:
-    int     _multiplier;
-    Score  *_aces;
-    Score  *_twos;
-    Score  *_threes;
-    Score  *_fours;
-    Score  *_fives;
-    Score  *_sixes;
-    Score  *_upper_sub_total;
-    Score  *_bonus;
-    Score  *_upper_total;
-    Score  *_three_of_a_kind;
-    Score  *_four_of_a_kind;
-    Score  *_full_house;
-    Score  *_small_straight;
-    Score  *_large_straight;
-    Score  *_yahtzee;
-    Score  *_chance;
-    Score  *_lower_section_total;
-    Score  *_upper_section_total;
-    Score  *_combined_total;
-    Score  *_total;
+    QWidget                    *_sheet;
+    std::vector<ScoreColumn *>  _columns;
+    bool                        _sheet_updates;     // whether the sheet was being repainted before
 };
 
 #endif // SCORECOLUMN_H
@@ -25,12 +25,9 @@
 #include <QLabel>
 #include <QString>
 
-#include <functional>
 #include <optional>
 #include <tuple>
 
-#include "dice.h"
-#include "gamescorer.h"
 #include "score.h"
 
 
@@ -112,12 +109,6 @@ public:
         ui_enabled(true);
     }
 
-    int get_score_value(const Dice &dice,
-                        std::function<int(const GameScorer &)> func)
-    {
-        return func(GameScorer{dice});
-    }
-
     std::tuple<Score *, Score *, Score *> get_scores() const
     {
         return {_score_single, _score_double, _score_triple};
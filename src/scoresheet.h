@@ -0,0 +1,219 @@
+#ifndef SCORESHEET_H
+#define SCORESHEET_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include "gamescorer.h"
+
+///
+/// \brief The totals of a single score column.
+///
+struct ColumnTotals
+{
+    int     upper_sub_total{0};
+    int     bonus{0};
+    int     upper_total{0};
+    int     lower_total{0};
+    int     combined_total{0};
+    int     total{0};           // combined_total times the column's multiplier
+};
+
+///
+/// \brief The scores of a game of Triple Yahtzee, laid out contiguously.
+///
+/// Cells are indexed by column and category. Each column keeps a mask of its
+/// filled cells and running sums of its upper and lower sections, which are
+/// updated as cells change, so totals never have to add up the cells again.
+/// The sheet is small and trivially copyable, so a snapshot of it is a plain
+/// copy.
+///
+class ScoreSheet
+{
+public:
+    static constexpr size_t         column_count{3};
+    static constexpr int            upper_bonus_threshold{63};
+    static constexpr int            upper_bonus{35};
+    static constexpr std::uint16_t  upper_mask{(1u << (static_cast<unsigned>(Category::Sixes) + 1)) - 1};
+    static constexpr std::uint16_t  complete_mask{(1u << category_count) - 1};
+
+    ///
+    /// \brief  Construct an empty ScoreSheet.
+    ///
+    constexpr ScoreSheet() noexcept
+    {
+        clear();
+    }
+
+    ///
+    /// \brief  Clear every cell of the sheet.
+    ///
+    constexpr void clear() noexcept
+    {
+        for (size_t column{0}; column < column_count; ++column)
+        {
+            for (auto &cell : _cells[column])
+                cell = -1;
+            _filled[column] = 0;
+            _upper[column] = 0;
+            _lower[column] = 0;
+        }
+    }
+
+    ///
+    /// \brief  Determine whether a cell has been scored.
+    /// \param column   Zero-based index of the column.
+    /// \param category The category within the column.
+    ///
+    constexpr bool is_filled(size_t column, Category category) const noexcept
+    {
+        return (_filled[column] >> static_cast<unsigned>(category)) & 1;
+    }
+    ///
+    /// \brief  Retrieve the mask of a column's filled cells.
+    /// \param column   Zero-based index of the column.
+    /// \return The mask. Bit \c n is set when Category \c n has been scored.
+    ///
+    constexpr std::uint16_t filled(size_t column) const noexcept
+    {
+        return _filled[column];
+    }
+    ///
+    /// \brief  Determine whether no cell of the sheet has been scored.
+    ///
+    constexpr bool is_empty() const noexcept
+    {
+        return (_filled[0] | _filled[1] | _filled[2]) == 0;
+    }
+    ///
+    /// \brief  Determine whether every cell of the sheet has been scored.
+    ///
+    constexpr bool is_complete() const noexcept
+    {
+        return (_filled[0] & _filled[1] & _filled[2]) == complete_mask;
+    }
+
+    ///
+    /// \brief  Retrieve the score in a single cell.
+    /// \param column   Zero-based index of the column.
+    /// \param category The category within the column.
+    /// \return The score, or an empty \c std::optional if the cell has not been scored.
+    ///
+    constexpr std::optional<int> cell(size_t column, Category category) const noexcept
+    {
+        const auto  value{_cells[column][static_cast<size_t>(category)]};
+
+        if (value < 0)
+            return std::nullopt;
+        return value;
+    }
+
+    ///
+    /// \brief  Score a cell, replacing any score it already holds.
+    /// \param column   Zero-based index of the column.
+    /// \param category The category within the column.
+    /// \param score    The score, from zero through 50.
+    ///
+    constexpr void set(size_t column, Category category, int score) noexcept
+    {
+        clear(column, category);
+        _cells[column][static_cast<size_t>(category)] = static_cast<std::int8_t>(score);
+        _filled[column] |= bit(category);
+        section(column, category) += static_cast<std::int16_t>(score);
+    }
+    ///
+    /// \brief  Clear a single cell.
+    /// \param column   Zero-based index of the column.
+    /// \param category The category within the column.
+    ///
+    constexpr void clear(size_t column, Category category) noexcept
+    {
+        auto   &value{_cells[column][static_cast<size_t>(category)]};
+
+        if (value < 0)
+            return;
+        section(column, category) -= value;
+        _filled[column] &= ~bit(category);
+        value = -1;
+    }
+
+    ///
+    /// \brief  Retrieve the multiplier applied to a column's combined total.
+    /// \param column   Zero-based index of the column.
+    ///
+    static constexpr int multiplier(size_t column) noexcept
+    {
+        return static_cast<int>(column) + 1;
+    }
+
+    ///
+    /// \brief  Retrieve the totals of a score column.
+    /// \param column   Zero-based index of the column.
+    ///
+    constexpr ColumnTotals totals(size_t column) const noexcept
+    {
+        ColumnTotals    totals;
+
+        totals.upper_sub_total = _upper[column];
+        totals.bonus = totals.upper_sub_total >= upper_bonus_threshold ? upper_bonus : 0;
+        totals.upper_total = totals.upper_sub_total + totals.bonus;
+        totals.lower_total = _lower[column];
+        totals.combined_total = totals.upper_total + totals.lower_total;
+        totals.total = totals.combined_total * multiplier(column);
+
+        return totals;
+    }
+    ///
+    /// \brief  Retrieve the sum of all three columns' totals.
+    ///
+    constexpr int grand_total() const noexcept
+    {
+        int total{0};
+
+        for (size_t column{0}; column < column_count; ++column)
+            total += totals(column).total;
+
+        return total;
+    }
+
+private:
+    static constexpr std::uint16_t bit(Category category) noexcept
+    {
+        return static_cast<std::uint16_t>(1u << static_cast<unsigned>(category));
+    }
+    constexpr std::int16_t &section(size_t column, Category category) noexcept
+    {
+        return category <= Category::Sixes ? _upper[column] : _lower[column];
+    }
+
+    std::array<std::array<std::int8_t, category_count>, column_count>   _cells{};   // -1 marks an empty cell
+    std::array<std::uint16_t, column_count>                             _filled{};
+    std::array<std::int16_t, column_count>                              _upper{};   // running sum of the upper section
+    std::array<std::int16_t, column_count>                              _lower{};   // running sum of the lower section
+};
+
+static_assert(std::is_trivially_copyable_v<ScoreSheet>);
+
+#endif // SCORESHEET_H
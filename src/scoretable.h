@@ -0,0 +1,205 @@
+#ifndef SCORETABLE_H
+#define SCORETABLE_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gamescorer.h"
+
+///
+/// \brief The scores a set of dice earns in each of the thirteen categories,
+///        indexed by \c Category.
+///
+using CategoryScores = std::array<std::uint8_t, category_count>;
+
+namespace scoretable_detail {
+
+///
+/// \brief  Binomial coefficients C(n, k) for n in [0, 10) and k in [0, 6).
+///
+constexpr std::array<std::array<int, 6>, 10> make_binomials()
+{
+    std::array<std::array<int, 6>, 10>  table{};
+
+    for (size_t n{0}; n < table.size(); ++n)
+    {
+        table[n][0] = 1;
+        for (size_t k{1}; k < table[n].size(); ++k)
+            table[n][k] = n == 0 ? 0 : table[n - 1][k - 1] + table[n - 1][k];
+    }
+    return table;
+}
+
+constexpr std::array<std::array<int, 6>, 10>    binomials{make_binomials()};
+
+///
+/// \brief  Rank a multiset of five dice, given as pip counts, in the range [0, 252).
+///
+/// The faces are taken in ascending order as a[0] <= ... <= a[4]. Adding the
+/// position to each face gives a strictly increasing sequence drawn from
+/// [0, 10), whose rank in the combinatorial number system is unique.
+///
+constexpr int rank(const std::array<int, 6> &pip_counts) noexcept
+{
+    int ndx{0};
+    int pos{0};
+
+    for (int face{0}; face < 6; ++face)
+        for (int c{0}; c < pip_counts[face]; ++c, ++pos)
+            ndx += binomials[face + pos][pos + 1];
+
+    return ndx;
+}
+
+struct Tables
+{
+    std::array<CategoryScores, 252>         scores{};
+    std::array<std::array<int, 6>, 252>     pip_counts{};
+};
+
+constexpr Tables make_tables()
+{
+    Tables  tables{};
+
+    for (int a{0}; a < 6; ++a)
+        for (int b{a}; b < 6; ++b)
+            for (int c{b}; c < 6; ++c)
+                for (int d{c}; d < 6; ++d)
+                    for (int e{d}; e < 6; ++e)
+                    {
+                        std::array<int, 6>  counts{0, 0, 0, 0, 0, 0};
+
+                        ++counts[a];
+                        ++counts[b];
+                        ++counts[c];
+                        ++counts[d];
+                        ++counts[e];
+
+                        const GameScorer    scorer{counts};
+                        const int           ndx{rank(counts)};
+
+                        tables.pip_counts[ndx] = counts;
+                        for (size_t cat{0}; cat < category_count; ++cat)
+                            tables.scores[ndx][cat] = static_cast<std::uint8_t>(scorer.score(static_cast<Category>(cat)));
+                    }
+
+    return tables;
+}
+
+constexpr Tables    tables{make_tables()};
+
+}   // namespace scoretable_detail
+
+///
+/// \brief Compile-time table of the category scores for every distinct roll.
+///
+/// Five six-sided dice have 252 distinct outcomes once their order is ignored.
+/// Each outcome is identified by an index in the range [0, 252), and a single
+/// lookup yields the scores for all thirteen categories.
+///
+class ScoreTable
+{
+public:
+    ///
+    /// \brief The number of distinct outcomes of rolling five dice.
+    ///
+    static constexpr size_t size{252};
+
+    ///
+    /// \brief  Retrieve the index of a roll given as the number of dice showing each face.
+    /// \param pip_counts   The number of dice showing one through six pips.
+    /// \return The index of the roll, in the range [0, 252).
+    ///
+    static constexpr int index(const std::array<int, 6> &pip_counts) noexcept
+    {
+        return scoretable_detail::rank(pip_counts);
+    }
+
+    ///
+    /// \brief  Retrieve the index of a roll given as five face values.
+    /// \param faces    The face value, one through six, of each die.
+    /// \return The index of the roll, in the range [0, 252).
+    ///
+    static constexpr int index(const std::array<int, 5> &faces) noexcept
+    {
+        std::array<int, 6>  counts{0, 0, 0, 0, 0, 0};
+
+        for (const auto face : faces)
+            ++counts[face - 1];
+
+        return index(counts);
+    }
+
+    ///
+    /// \brief  Retrieve the index of the roll currently showing on a set of dice.
+    /// \param dice Reference to a PackedDice object containing rolled dice.
+    /// \return The index of the roll, in the range [0, 252).
+    ///
+    static constexpr int index(const PackedDice &dice) noexcept
+    {
+        return index(dice.pip_counts());
+    }
+
+    ///
+    /// \brief  Retrieve the scores of a roll in all categories.
+    /// \param ndx  The index of the roll, in the range [0, 252).
+    /// \return A reference to the scores, indexed by \c Category.
+    ///
+    static constexpr const CategoryScores &scores(int ndx) noexcept
+    {
+        return scoretable_detail::tables.scores[ndx];
+    }
+
+    ///
+    /// \brief  Retrieve the scores of the roll currently showing on a set of dice.
+    /// \param dice Reference to a PackedDice object containing rolled dice.
+    /// \return A reference to the scores, indexed by \c Category.
+    ///
+    static constexpr const CategoryScores &scores(const PackedDice &dice) noexcept
+    {
+        return scores(index(dice));
+    }
+
+    ///
+    /// \brief  Retrieve the score of a roll in a single category.
+    /// \param ndx      The index of the roll, in the range [0, 252).
+    /// \param category The category to be scored.
+    /// \return The score the roll earns in the given category.
+    ///
+    static constexpr int score(int ndx, Category category) noexcept
+    {
+        return scores(ndx)[static_cast<size_t>(category)];
+    }
+
+    ///
+    /// \brief  Retrieve the number of dice showing each face for a roll.
+    /// \param ndx  The index of the roll, in the range [0, 252).
+    /// \return The number of dice showing one through six pips.
+    ///
+    static constexpr const std::array<int, 6> &pip_counts(int ndx) noexcept
+    {
+        return scoretable_detail::tables.pip_counts[ndx];
+    }
+};
+
+#endif // SCORETABLE_H
@@ -0,0 +1,394 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "columnsolver.h"
+#include "strategyfile.h"
+#include "triplesolver.h"
+
+namespace {
+constexpr char          Magic[8]{'T', 'Y', 'T', 'Z', 'S', 'T', 'R', 'T'};
+constexpr std::uint32_t ByteOrder{0x01020304};
+constexpr std::uint64_t PageSize{4096};
+
+///
+/// \brief The fixed header at the start of every strategy file.
+///
+struct Header
+{
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   byte_order;         // detects files written on a machine of different endianness
+    std::uint32_t   kind;
+    std::uint32_t   reserved;
+    std::uint64_t   entry_count;        // number of states with values
+    std::uint64_t   slot_count;         // number of table elements; a power of two for Triple tables
+    std::uint64_t   corrections_offset; // Triple tables only; zero otherwise
+    std::uint64_t   table_offset;
+    std::uint64_t   table_size;
+};
+
+Header make_header(StrategyFile::Kind kind, std::uint64_t entry_count, std::uint64_t slot_count, std::uint64_t table_size)
+{
+    Header  header{};
+
+    std::copy(std::begin(Magic), std::end(Magic), header.magic);
+    header.version = StrategyFile::version;
+    header.byte_order = ByteOrder;
+    header.kind = static_cast<std::uint32_t>(kind);
+    header.entry_count = entry_count;
+    header.slot_count = slot_count;
+    header.table_offset = PageSize;
+    header.table_size = table_size;
+
+    return header;
+}
+
+///
+/// \brief  Write a strategy file to a temporary file, then rename it into place.
+///
+/// Replacing the file rather than overwriting it leaves any process that has
+/// the old file mapped with a consistent view of it.
+template <typename Func>
+bool write_file(const std::string &path, const Header &header, Func write_body)
+{
+    const std::string   temp{path + ".tmp"};
+
+    {
+        std::ofstream   file{temp, std::ios::binary | std::ios::trunc};
+
+        if (!file)
+            return false;
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        write_body(file);
+        if (!file.flush())
+        {
+            file.close();
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+
+#if defined(_WIN32)
+    const bool  renamed{MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0};
+#else
+    const bool  renamed{std::rename(temp.c_str(), path.c_str()) == 0};
+#endif
+
+    if (!renamed)
+        std::remove(temp.c_str());
+
+    return renamed;
+}
+
+void pad_to(std::ofstream &file, std::uint64_t offset)
+{
+    const auto  position{static_cast<std::uint64_t>(file.tellp())};
+
+    if (position < offset)
+    {
+        const std::vector<char> zeros(offset - position, 0);
+
+        file.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    }
+}
+}   // anonymous namespace
+
+StrategyFile::~StrategyFile()
+{
+    close();
+}
+
+///
+/// \brief StrategyFile::open   Map a strategy file into memory.
+/// \param path The location of the file.
+/// \return true if the file was mapped, false if it is missing, unreadable, or
+///         not a strategy file of this version.
+///
+/// Only the header is examined; the table itself is read on demand.
+bool StrategyFile::open(const std::string &path)
+{
+    close();
+
+#if defined(_WIN32)
+    HANDLE  file{CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)};
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER   size;
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(Header)))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE  mapping{CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)};
+
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+
+    void   *base{MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)};
+
+    if (!base)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    _mapping = mapping;
+    _size = static_cast<size_t>(size.QuadPart);
+#else
+    const int   fd{::open(path.c_str(), O_RDONLY)};
+
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header)))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void   *base{mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0)};
+
+    ::close(fd);
+    if (base == MAP_FAILED)
+        return false;
+    _size = static_cast<size_t>(st.st_size);
+#endif
+    _base = base;
+
+    Header  header;
+
+    std::memcpy(&header, _base, sizeof(header));
+
+    const bool  valid{   std::equal(std::begin(Magic), std::end(Magic), header.magic)
+                      && header.version == version
+                      && header.byte_order == ByteOrder
+                      && header.table_offset >= sizeof(Header)
+                      && header.table_offset <= _size
+                      && header.table_size <= _size - header.table_offset};
+
+    if (!valid)
+    {
+        close();
+        return false;
+    }
+
+    const auto  bytes{static_cast<const unsigned char *>(_base)};
+
+    _kind = static_cast<Kind>(header.kind);
+    _table = bytes + header.table_offset;
+    _entry_count = header.entry_count;
+
+    // Sizes are compared by division so that a crafted slot count cannot overflow.
+    if (   _kind == Kind::Column
+        && header.slot_count == header.entry_count
+        && header.table_size % sizeof(float) == 0
+        && header.table_size / sizeof(float) == header.slot_count)
+    {
+        _slot_count = header.slot_count;
+        return true;
+    }
+
+    if (   _kind == Kind::Triple
+        && header.slot_count != 0
+        && (header.slot_count & (header.slot_count - 1)) == 0
+        && header.table_size % sizeof(Slot) == 0
+        && header.table_size / sizeof(Slot) == header.slot_count
+        && header.corrections_offset >= sizeof(Header)
+        && header.table_offset >= level_count * sizeof(float)
+        && header.corrections_offset <= header.table_offset - level_count * sizeof(float))
+    {
+        _corrections = reinterpret_cast<const float *>(bytes + header.corrections_offset);
+        _slot_count = header.slot_count;
+        _slot_mask = header.slot_count - 1;
+        return true;
+    }
+
+    close();
+    return false;
+}
+
+///
+/// \brief StrategyFile::close  Unmap the open file, if any.
+///
+void StrategyFile::close() noexcept
+{
+    if (_base)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(_base);
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+#else
+        munmap(_base, _size);
+#endif
+    }
+    _base = nullptr;
+    _size = 0;
+    _table = nullptr;
+    _corrections = nullptr;
+    _entry_count = 0;
+    _slot_count = 0;
+    _slot_mask = 0;
+}
+
+///
+/// \brief StrategyFile::triple_value   Look up the refined value of a Triple state.
+/// \param key      The state's key, from \c TripleState::key().
+/// \param value    Receives the value if the state is in the table.
+/// \return true if the state is in the table, false otherwise.
+///
+bool StrategyFile::triple_value(std::uint64_t key, float &value) const noexcept
+{
+    if (_kind != Kind::Triple || !_table)
+        return false;
+
+    const auto  slots{static_cast<const Slot *>(_table)};
+    const auto  tag{key | used_bit};
+
+    // A table with no empty slot would never end the probe, so give up after every slot.
+    auto    i{hash(key) & _slot_mask};
+
+    for (std::uint64_t probes{0}; probes <= _slot_mask && slots[i].tag; ++probes, i = (i + 1) & _slot_mask)
+    {
+        if (slots[i].tag == tag)
+        {
+            value = slots[i].value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+///
+/// \brief StrategyFile::triple_correction  Retrieve the mean refinement of states with a given number of filled cells.
+/// \param level    The number of filled cells.
+///
+float StrategyFile::triple_correction(size_t level) const noexcept
+{
+    if (!_corrections || level >= level_count)
+        return 0.0f;
+
+    return _corrections[level];
+}
+
+///
+/// \brief StrategyFile::write  Write a column value table to a file.
+/// \param path     The location of the file.
+/// \param solver   A solved ColumnSolver.
+/// \return true if the file was written, false otherwise.
+///
+bool StrategyFile::write(const std::string &path, const ColumnSolver &solver)
+{
+    const Header    header{make_header(Kind::Column, ColumnSolver::state_count, ColumnSolver::state_count,
+                                       ColumnSolver::state_count * sizeof(float))};
+
+    return write_file(path, header, [&](std::ofstream &file)
+    {
+        pad_to(file, header.table_offset);
+        file.write(reinterpret_cast<const char *>(solver.values()), static_cast<std::streamsize>(header.table_size));
+    });
+}
+
+///
+/// \brief StrategyFile::write  Write the refined values of a TripleSolver to a file.
+/// \param path     The location of the file.
+/// \param solver   The TripleSolver.
+/// \return true if the file was written, false otherwise.
+///
+/// The hash table is kept at most half full so that lookups stay short.
+bool StrategyFile::write(const std::string &path, const TripleSolver &solver)
+{
+    std::vector<Slot>   slots(1);
+    std::uint64_t       entries{0};
+
+    solver.for_each_cached([&](std::uint64_t key, float value)
+    {
+        if ((entries + 1) * 2 > slots.size())
+        {
+            std::vector<Slot>   grown(slots.size() * 2);
+            const auto          mask{grown.size() - 1};
+
+            for (const auto &slot : slots)
+                if (slot.tag)
+                {
+                    auto    i{hash(slot.tag & ~used_bit) & mask};
+
+                    while (grown[i].tag)
+                        i = (i + 1) & mask;
+                    grown[i] = slot;
+                }
+            slots.swap(grown);
+        }
+
+        const auto  mask{slots.size() - 1};
+        auto        i{hash(key) & mask};
+
+        while (slots[i].tag && slots[i].tag != (key | used_bit))
+            i = (i + 1) & mask;
+        if (!slots[i].tag)      // the first value seen for a state wins
+        {
+            slots[i] = Slot{key | used_bit, value, 0};
+            ++entries;
+        }
+    });
+
+    std::vector<float>  corrections(level_count);
+
+    for (size_t level{0}; level < level_count; ++level)
+        corrections[level] = solver.level_correction(level);
+
+    Header  header{make_header(Kind::Triple, entries, slots.size(), slots.size() * sizeof(Slot))};
+
+    header.corrections_offset = sizeof(Header);
+
+    return write_file(path, header, [&](std::ofstream &file)
+    {
+        file.write(reinterpret_cast<const char *>(corrections.data()), static_cast<std::streamsize>(corrections.size() * sizeof(float)));
+        pad_to(file, header.table_offset);
+        file.write(reinterpret_cast<const char *>(slots.data()), static_cast<std::streamsize>(header.table_size));
+    });
+}
@@ -0,0 +1,170 @@
+#ifndef STRATEGYFILE_H
+#define STRATEGYFILE_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class ColumnSolver;
+class TripleSolver;
+struct ColumnState;
+
+///
+/// \brief A read-only, memory-mapped strategy table written by the solvers.
+///
+/// A strategy file begins with a fixed header that identifies the file,
+/// its format version, and the kind of table it holds, followed by the table
+/// itself starting on a page boundary. Opening a file maps it into memory
+/// without reading it; the operating system loads pages as they are first
+/// touched and shares them among all processes that map the same file.
+///
+/// A column table holds the value of every ColumnState, indexed directly by
+/// \c ColumnSolver::state_index(). A Triple table holds the refined values of
+/// TripleState keys in an open-addressed hash table, preceded by the mean
+/// refinement of each number of filled cells. Both give O(1) lookups.
+///
+class StrategyFile
+{
+public:
+    ///
+    /// \brief The kinds of table a strategy file can hold.
+    ///
+    enum class Kind : std::uint32_t
+    {
+        Column = 1,
+        Triple = 2
+    };
+
+    static constexpr std::uint32_t  version{1};
+    static constexpr size_t         level_count{39};
+
+    StrategyFile() = default;
+    ~StrategyFile();
+
+    StrategyFile(const StrategyFile &) = delete;
+    StrategyFile &operator=(const StrategyFile &) = delete;
+
+    bool open(const std::string &path);
+    void close() noexcept;
+
+    ///
+    /// \brief  Determine whether a file is open.
+    ///
+    bool is_open() const noexcept
+    {
+        return _base != nullptr;
+    }
+
+    ///
+    /// \brief  Retrieve the kind of table in the open file.
+    ///
+    Kind kind() const noexcept
+    {
+        return _kind;
+    }
+
+    ///
+    /// \brief  Retrieve the value table of an open column file, indexed by \c ColumnSolver::state_index().
+    ///
+    const float *column_values() const noexcept
+    {
+        return _kind == Kind::Column ? static_cast<const float *>(_table) : nullptr;
+    }
+
+    bool triple_value(std::uint64_t key, float &value) const noexcept;
+    float triple_correction(size_t level) const noexcept;
+
+    ///
+    /// \brief  Call a function for each state in an open Triple file, passing its key and value.
+    ///
+    template <typename Func>
+    void for_each_triple(Func func) const
+    {
+        if (_kind != Kind::Triple || !_table)
+            return;
+
+        const auto  slots{static_cast<const Slot *>(_table)};
+
+        for (std::uint64_t i{0}; i <= _slot_mask; ++i)
+            if (slots[i].tag)
+                func(slots[i].tag & ~used_bit, slots[i].value);
+    }
+
+    ///
+    /// \brief  Retrieve the number of states in the open file's table.
+    ///
+    std::uint64_t entry_count() const noexcept
+    {
+        return _entry_count;
+    }
+
+    ///
+    /// \brief  Retrieve the number of elements in the open file's table.
+    ///
+    std::uint64_t slot_count() const noexcept
+    {
+        return _slot_count;
+    }
+
+    static bool write(const std::string &path, const ColumnSolver &solver);
+    static bool write(const std::string &path, const TripleSolver &solver);
+
+    ///
+    /// \brief  Mix the bits of a state key to choose a hash table slot.
+    ///
+    static constexpr std::uint64_t hash(std::uint64_t key) noexcept
+    {
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDull;
+        key ^= key >> 33;
+        key *= 0xC4CEB9FE1A85EC53ull;
+        key ^= key >> 33;
+        return key;
+    }
+
+private:
+    static constexpr std::uint64_t  used_bit{std::uint64_t{1} << 63};
+
+    ///
+    /// \brief One slot of a Triple table's hash table.
+    ///
+    struct Slot
+    {
+        std::uint64_t   tag;        // state key with used_bit set, or zero if empty
+        float           value;
+        std::uint32_t   reserved;
+    };
+
+    void           *_base{nullptr};
+    size_t          _size{0};
+    Kind            _kind{Kind::Column};
+    const void     *_table{nullptr};
+    const float    *_corrections{nullptr};
+    std::uint64_t   _entry_count{0};
+    std::uint64_t   _slot_count{0};
+    std::uint64_t   _slot_mask{0};
+#if defined(_WIN32)
+    void           *_mapping{nullptr};
+#endif
+};
+
+#endif // STRATEGYFILE_H
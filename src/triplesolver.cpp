@@ -0,0 +1,464 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "facegenerator.h"
+#include "rerolltable.h"
+#include "scoretable.h"
+#include "triplesolver.h"
+
+namespace {
+constexpr bool is_upper(Category category) noexcept
+{
+    return category <= Category::Sixes;
+}
+
+///
+/// \brief  Roll the dice not kept and return the index of the resulting roll.
+///
+int roll_dice(std::array<int, 6> counts, int kept, FaceGenerator &gen)
+{
+    for (int d{kept}; d < 5; ++d)
+        ++counts[gen.face() - 1];
+
+    return ScoreTable::index(counts);
+}
+}   // anonymous namespace
+
+size_t TripleState::filled_count() const noexcept
+{
+    size_t  count{0};
+
+    for (const auto &column : columns)
+        count += std::bitset<category_count>{column.filled}.count();
+
+    return count;
+}
+
+///
+/// \brief TripleState::from    Determine the state of a game's score sheet.
+/// \param game The game.
+///
+TripleState TripleState::from(const GameEngine &game) noexcept
+{
+    const auto &sheet{game.sheet()};
+    TripleState state{};
+
+    for (size_t c{0}; c < state.columns.size(); ++c)
+    {
+        const int   upper{sheet.totals(c).upper_sub_total};
+
+        state.columns[c].filled = sheet.filled(c);
+        state.columns[c].upper = static_cast<std::uint8_t>(std::min(upper, ColumnSolver::upper_cap));
+    }
+
+    return state;
+}
+
+///
+/// \brief TripleSolver::TripleSolver   Construct a TripleSolver.
+/// \param column           A solved ColumnSolver. It must outlive the TripleSolver.
+/// \param memory_budget    The most memory, in bytes, to use for refined state values.
+///
+TripleSolver::TripleSolver(const ColumnSolver &column, size_t memory_budget)
+  : _column{column}
+  , _shards(shard_count)
+  , _shard_size{std::max<size_t>(1, memory_budget / sizeof(Entry) / shard_count)}
+{
+    for (auto &shard : _shards)
+        shard.entries.resize(_shard_size);
+}
+
+bool TripleSolver::lookup(std::uint64_t key, float &value) const noexcept
+{
+    const auto      hash{StrategyFile::hash(key)};
+    const Shard    &shard{_shards[hash % shard_count]};
+    std::lock_guard<std::mutex>  lock{shard.mutex};
+    const Entry    &entry{shard.entries[(hash / shard_count) % _shard_size]};
+
+    if (entry.tag != (key | used_bit))
+        return false;
+
+    value = entry.value;
+    return true;
+}
+
+void TripleSolver::store(std::uint64_t key, float value) noexcept
+{
+    const auto  hash{StrategyFile::hash(key)};
+    Shard      &shard{_shards[hash % shard_count]};
+    std::lock_guard<std::mutex>  lock{shard.mutex};
+    Entry      &entry{shard.entries[(hash / shard_count) % _shard_size]};
+
+    if (!entry.tag)
+        _cached.fetch_add(1, std::memory_order_relaxed);
+    entry.tag = key | used_bit;
+    entry.value = value;
+}
+
+///
+/// \brief  Record how far refinement moved a state's value from the approximation.
+///
+void TripleSolver::record(const TripleState &state, float refined) noexcept
+{
+    const size_t    level{state.filled_count()};
+    const float     delta{refined - approximate_value(state)};
+
+    _delta_sums[level].fetch_add(std::llround(delta * fixed_point), std::memory_order_relaxed);
+    _delta_counts[level].fetch_add(1, std::memory_order_relaxed);
+}
+
+///
+/// \brief TripleSolver::level_correction   Retrieve the mean amount refinement has added
+///                                         to states with a given number of filled cells.
+/// \param level    The number of filled cells.
+///
+/// Until this solver has refined such a state, the amount recorded in a loaded
+/// strategy file is used.
+float TripleSolver::level_correction(size_t level) const noexcept
+{
+    if (level >= level_count)
+        return 0.0f;
+
+    const auto  count{_delta_counts[level].load(std::memory_order_relaxed)};
+
+    if (count == 0)
+        return _file ? _file->triple_correction(level) : 0.0f;
+
+    return static_cast<float>(_delta_sums[level].load(std::memory_order_relaxed)) / static_cast<float>(fixed_point * count);
+}
+
+///
+/// \brief TripleSolver::save   Write the refined state values to a strategy file.
+/// \param path The location of the file.
+/// \return true if the file was written, false otherwise.
+///
+bool TripleSolver::save(const std::string &path) const
+{
+    return StrategyFile::write(path, *this);
+}
+
+///
+/// \brief TripleSolver::load   Use the refined state values in a strategy file written by \c save().
+/// \param path The location of the file.
+/// \return true if the table was mapped, false if the file is missing or not a Triple table.
+///
+/// The file is mapped into memory rather than read. Its values are used for
+/// states this solver has not refined itself.
+bool TripleSolver::load(const std::string &path)
+{
+    auto    file{std::make_unique<StrategyFile>()};
+
+    if (!file->open(path) || file->kind() != StrategyFile::Kind::Triple)
+        return false;
+
+    _file = std::move(file);
+    return true;
+}
+
+///
+/// \brief TripleSolver::approximate_value  Estimate the expected score of the rest of a game
+///                                         from the independent column values.
+/// \param state    The state of the score sheet at the start of a turn.
+///
+float TripleSolver::approximate_value(const TripleState &state) const noexcept
+{
+    float   value{0.0f};
+
+    for (size_t c{0}; c < state.columns.size(); ++c)
+        value += static_cast<float>(GameEngine::multiplier(c)) * _column.value(state.columns[c]);
+
+    return value;
+}
+
+///
+/// \brief TripleSolver::value  Retrieve the best available estimate of the expected score
+///                             of the rest of a game.
+/// \param state    The state of the score sheet at the start of a turn.
+/// \return The refined value if the state has one, otherwise the approximate value
+///         shifted by the mean refinement of similar states.
+///
+float TripleSolver::value(const TripleState &state) const noexcept
+{
+    if (state.is_complete())
+        return 0.0f;
+
+    const auto  key{state.key()};
+    float       refined;
+
+    if (lookup(key, refined) || (_file && _file->triple_value(key, refined)))
+        return refined;
+
+    return approximate_value(state) + level_correction(state.filled_count());
+}
+
+///
+/// \brief TripleSolver::score_values   Calculate the value of each final roll of a turn.
+/// \param state    The state of the score sheet at the start of the turn. It must
+///                 have at least one open cell.
+/// \param out      Receives, for each roll, the best total of the multiplied score
+///                 and bonus earned and the value of the state that follows.
+///
+void TripleSolver::score_values(const TripleState &state, RollValues &out) const noexcept
+{
+    struct Open
+    {
+        size_t      column;
+        Category    category;
+        float       multiplier;
+        float       next[6];    // value of the following state, by count of dice for upper categories
+    };
+
+    std::array<Open, GameEngine::column_count * category_count> open;
+    size_t                                                      open_count{0};
+
+    // The state after scoring depends on the score only through the upper
+    // subtotal, so look up each following state once rather than per roll.
+    for (size_t c{0}; c < state.columns.size(); ++c)
+    {
+        const auto &column{state.columns[c]};
+
+        for (size_t k{0}; k < category_count; ++k)
+        {
+            const auto  category{static_cast<Category>(k)};
+
+            if (column.is_filled(category))
+                continue;
+
+            Open   &cell{open[open_count++]};
+            const int   counts{is_upper(category) ? 6 : 1};
+
+            cell.column = c;
+            cell.category = category;
+            cell.multiplier = static_cast<float>(GameEngine::multiplier(c));
+            for (int n{0}; n < counts; ++n)
+            {
+                const int   score{is_upper(category) ? n * static_cast<int>(k + 1) : 0};
+                TripleState next{state};
+
+                next.columns[c] = column.after(category, score);
+                cell.next[n] = cell.multiplier * static_cast<float>(column.bonus_for(category, score)) + value(next);
+            }
+        }
+    }
+
+    for (size_t roll{0}; roll < out.size(); ++roll)
+    {
+        const auto &scores{ScoreTable::scores(static_cast<int>(roll))};
+        const auto &counts{ScoreTable::pip_counts(static_cast<int>(roll))};
+        float       best{-1.0f};
+
+        for (size_t i{0}; i < open_count; ++i)
+        {
+            const auto &cell{open[i]};
+            const auto  k{static_cast<size_t>(cell.category)};
+            const float next{is_upper(cell.category) ? cell.next[counts[k]] : cell.next[0]};
+
+            best = std::max(best, cell.multiplier * static_cast<float>(scores[k]) + next);
+        }
+        out[roll] = best;
+    }
+}
+
+///
+/// \brief TripleSolver::roll_values    Calculate the value of each roll with some rerolls remaining.
+/// \param state        The state of the score sheet at the start of the turn.
+/// \param rolls_left   The number of rerolls remaining after the roll, zero through two.
+/// \param out          Receives the value of each roll.
+///
+void TripleSolver::roll_values(const TripleState &state, int rolls_left, RollValues &out) const noexcept
+{
+    RollValues  scratch;
+
+    score_values(state, out);
+    for (int r{0}; r < rolls_left; ++r)
+    {
+        TurnEvaluator::reroll_values(out, scratch);
+        out = scratch;
+    }
+}
+
+///
+/// \brief TripleSolver::turn_value Calculate the expected score of the rest of a game
+///                                 from the start of a turn.
+/// \param state    The state of the score sheet. It must have at least one open cell.
+///
+float TripleSolver::turn_value(const TripleState &state) const noexcept
+{
+    RollValues  first_roll;
+
+    roll_values(state, GameEngine::max_rolls - 1, first_roll);
+    return TurnEvaluator::roll_expectation(first_roll);
+}
+
+///
+/// \brief TripleSolver::cell_values    Calculate the value of scoring a final roll in each cell.
+/// \param state    The state of the score sheet.
+/// \param roll     The index of the roll.
+/// \param out      Receives, for each open cell, the multiplied score and bonus
+///                 earned and the value of the state that follows. Filled cells
+///                 receive -1.
+///
+void TripleSolver::cell_values(const TripleState &state, int roll, CellValues &out) const noexcept
+{
+    const auto &scores{ScoreTable::scores(roll)};
+
+    for (size_t c{0}; c < state.columns.size(); ++c)
+    {
+        const auto &column{state.columns[c]};
+        const auto  multiplier{static_cast<float>(GameEngine::multiplier(c))};
+
+        for (size_t k{0}; k < category_count; ++k)
+        {
+            const auto  category{static_cast<Category>(k)};
+            float      &cell{out[c * category_count + k]};
+
+            if (column.is_filled(category))
+            {
+                cell = -1.0f;
+                continue;
+            }
+
+            TripleState next{state};
+            const int   score{scores[k]};
+
+            next.columns[c] = column.after(category, score);
+            cell = multiplier * static_cast<float>(score + column.bonus_for(category, score)) + value(next);
+        }
+    }
+}
+
+///
+/// \brief TripleSolver::best_cell  Determine the best cell to score a final roll in.
+/// \param state    The state of the score sheet. It must have at least one open cell.
+/// \param roll     The index of the roll.
+///
+TripleCell TripleSolver::best_cell(const TripleState &state, int roll) const noexcept
+{
+    CellValues  values;
+
+    cell_values(state, roll, values);
+
+    const auto  best{static_cast<size_t>(std::max_element(values.begin(), values.end()) - values.begin())};
+
+    return TripleCell{best / category_count, static_cast<Category>(best % category_count)};
+}
+
+///
+/// \brief TripleSolver::update Refine the value of a state from the values of the states that follow it.
+/// \param state    The state of the score sheet. It must have at least one open cell.
+///
+void TripleSolver::update(const TripleState &state) noexcept
+{
+    const float refined{turn_value(state)};
+
+    record(state, refined);
+    store(state.key(), refined);
+}
+
+///
+/// \brief TripleSolver::solve  Refine state values by playing games with the current strategy.
+/// \param threads      The number of threads to use, or zero to use one per hardware thread.
+/// \param stop         Solving stops soon after this flag becomes true.
+/// \param seed         Seed for the dice rolled in the games played.
+/// \param max_games    The number of games to play, or zero to play until stopped.
+/// \return The number of games played.
+///
+/// Each thread plays its own games. At every turn it refines the value of the
+/// state it is in, then plays the turn by keeping the dice and choosing the
+/// cell that maximize the expected score under the current values.
+size_t TripleSolver::solve(unsigned threads, const std::atomic<bool> &stop, std::uint64_t seed, size_t max_games)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::atomic<size_t>         games{0};
+    std::vector<std::thread>    pool;
+
+    auto    worker = [&](unsigned id)
+    {
+        FaceGenerator   gen{seed + id};
+
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            if (max_games && games.fetch_add(1, std::memory_order_relaxed) >= max_games)
+                break;
+            if (!max_games)
+                games.fetch_add(1, std::memory_order_relaxed);
+
+            TripleState state{};
+
+            while (!state.is_complete() && !stop.load(std::memory_order_relaxed))
+            {
+                std::array<RollValues, GameEngine::max_rolls>   stages;     // indexed by rerolls remaining
+
+                score_values(state, stages[0]);
+                for (size_t r{1}; r < stages.size(); ++r)
+                    TurnEvaluator::reroll_values(stages[r - 1], stages[r]);
+                const float refined{TurnEvaluator::roll_expectation(stages.back())};
+
+                record(state, refined);
+                store(state.key(), refined);
+
+                int roll{roll_dice({0, 0, 0, 0, 0, 0}, 0, gen)};
+
+                for (size_t r{stages.size() - 1}; r > 0; --r)
+                {
+                    int     best_keep{-1};
+                    float   best{-1.0f};
+
+                    // Only the keeps of this roll are valued, each from its own outcomes.
+                    for (const auto keep : RerollTable::keeps(roll))
+                    {
+                        const float ev{TurnEvaluator::keep_value(stages[r - 1], keep)};
+
+                        if (ev > best)
+                        {
+                            best = ev;
+                            best_keep = keep;
+                        }
+                    }
+                    roll = roll_dice(RerollTable::keep_counts(best_keep), RerollTable::keep_size(best_keep), gen);
+                }
+
+                const auto  cell{best_cell(state, roll)};
+
+                state.columns[cell.column] = state.columns[cell.column].after(cell.category, ScoreTable::score(roll, cell.category));
+            }
+        }
+    };
+
+    for (unsigned t{1}; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &t : pool)
+        t.join();
+
+    return max_games ? std::min(games.load(), max_games) : games.load();
+}
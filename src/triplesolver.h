@@ -0,0 +1,188 @@
+#ifndef TRIPLESOLVER_H
+#define TRIPLESOLVER_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "columnsolver.h"
+#include "gameengine.h"
+#include "strategyfile.h"
+#include "turnevaluator.h"
+
+///
+/// \brief The state of all three score columns between turns.
+///
+struct TripleState
+{
+    std::array<ColumnState, GameEngine::column_count>   columns;
+
+    ///
+    /// \brief  Pack the state into 57 bits: 19 bits per column.
+    ///
+    constexpr std::uint64_t key() const noexcept
+    {
+        std::uint64_t   key{0};
+
+        for (size_t c{0}; c < columns.size(); ++c)
+            key |= std::uint64_t{ColumnSolver::state_index(columns[c])} << (19 * c);
+
+        return key;
+    }
+
+    constexpr bool is_complete() const noexcept
+    {
+        return columns[0].is_complete() && columns[1].is_complete() && columns[2].is_complete();
+    }
+
+    ///
+    /// \brief  Retrieve the number of cells filled in all three columns.
+    ///
+    size_t filled_count() const noexcept;
+
+    static TripleState from(const GameEngine &game) noexcept;
+};
+
+///
+/// \brief A cell of the score sheet chosen by the TripleSolver.
+///
+struct TripleCell
+{
+    size_t      column;
+    Category    category;
+};
+
+///
+/// \brief Builds Triple Yahtzee strategies from the single-column values.
+///
+/// The joint state of three columns is far too large to solve exactly, so the
+/// solver starts from the approximation that a joint state is worth the sum of
+/// its columns' optimal values, each times its column's multiplier. Decisions
+/// within a turn are made exactly against that approximation, choosing among
+/// the open cells of all three columns at once.
+///
+/// \c solve() refines the approximation by playing games with the current
+/// strategy and recomputing the value of each state it visits from the values
+/// of the states that follow. Refined values are kept in a cache of bounded
+/// size. Solving may be stopped at any time; the strategy is always usable,
+/// and it improves with each game played.
+///
+/// Refined values run higher than the approximation, because they account for
+/// choosing among all three columns. To keep refined and unrefined states
+/// comparable, the approximation is shifted by the mean amount refinement has
+/// added to the states with the same number of filled cells.
+///
+class TripleSolver
+{
+public:
+    ///
+    /// \brief A value for each cell of the score sheet, indexed by column times 13 plus category.
+    ///
+    using CellValues = std::array<float, GameEngine::column_count * category_count>;
+
+    TripleSolver(const ColumnSolver &column, size_t memory_budget = size_t{256} << 20);
+
+    TripleSolver(const TripleSolver &) = delete;
+    TripleSolver &operator=(const TripleSolver &) = delete;
+
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+
+    float approximate_value(const TripleState &state) const noexcept;
+    float value(const TripleState &state) const noexcept;
+    float level_correction(size_t level) const noexcept;
+
+    void score_values(const TripleState &state, RollValues &out) const noexcept;
+    void roll_values(const TripleState &state, int rolls_left, RollValues &out) const noexcept;
+    float turn_value(const TripleState &state) const noexcept;
+    void cell_values(const TripleState &state, int roll, CellValues &out) const noexcept;
+    TripleCell best_cell(const TripleState &state, int roll) const noexcept;
+
+    void update(const TripleState &state) noexcept;
+    size_t solve(unsigned threads, const std::atomic<bool> &stop, std::uint64_t seed, size_t max_games = 0);
+
+    ///
+    /// \brief  Retrieve the number of states whose values have been refined.
+    ///
+    size_t cached_states() const noexcept
+    {
+        return _cached.load(std::memory_order_relaxed);
+    }
+
+    ///
+    /// \brief  Call a function for each refined state, passing its key and value.
+    ///
+    /// States refined in this process come first, followed by those in a
+    /// loaded strategy file. A state may therefore be passed more than once.
+    template <typename Func>
+    void for_each_cached(Func func) const
+    {
+        for (const auto &shard : _shards)
+        {
+            std::lock_guard<std::mutex>  lock{shard.mutex};
+
+            for (const auto &entry : shard.entries)
+                if (entry.tag)
+                    func(entry.tag & ~used_bit, entry.value);
+        }
+        if (_file)
+            _file->for_each_triple(func);
+    }
+
+private:
+    static constexpr std::uint64_t  used_bit{std::uint64_t{1} << 63};
+    static constexpr size_t         shard_count{256};
+
+    struct Entry
+    {
+        std::uint64_t   tag{0};     // state key with used_bit set, or zero if empty
+        float           value{0.0f};
+    };
+
+    struct Shard
+    {
+        mutable std::mutex  mutex;
+        std::vector<Entry>  entries;
+    };
+
+    bool lookup(std::uint64_t key, float &value) const noexcept;
+    void store(std::uint64_t key, float value) noexcept;
+    void record(const TripleState &state, float refined) noexcept;
+
+    static constexpr size_t         level_count{GameEngine::column_count * category_count};
+    static constexpr std::int64_t   fixed_point{1024};
+
+    const ColumnSolver                 &_column;
+    std::vector<Shard>                  _shards;
+    size_t                              _shard_size;
+    std::atomic<size_t>                 _cached{0};
+    std::unique_ptr<StrategyFile>       _file;
+    std::array<std::atomic<std::int64_t>, level_count>  _delta_sums{};    // in 1/fixed_point points
+    std::array<std::atomic<std::int64_t>, level_count>  _delta_counts{};
+};
+
+#endif // TRIPLESOLVER_H
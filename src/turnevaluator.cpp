@@ -0,0 +1,101 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "rerolltable.h"
+#include "scoretable.h"
+#include "turnevaluator.h"
+
+///
+/// \brief TurnEvaluator::keep_value    Calculate the expected value of one keep.
+/// \param values   The value of each roll after the dice are rerolled.
+/// \param keep     The index of the keep.
+///
+/// The value is the sum over the rolls the keep can lead to of each roll's
+/// value times its probability, as given by \c RerollTable::outcomes.
+float TurnEvaluator::keep_value(const RollValues &values, int keep) noexcept
+{
+    float   ev{0.0f};
+
+    for (const auto &outcome : RerollTable::outcomes(keep))
+        ev += outcome.probability * values[outcome.roll];
+
+    return ev;
+}
+
+///
+/// \brief TurnEvaluator::keep_values   Calculate the expected value of every keep.
+/// \param values   The value of each roll after the dice are rerolled.
+/// \param out      Receives the expected value of each keep.
+///
+/// Each keep of fewer than five dice is worth the average of the keeps with
+/// one more die, so all 462 values are found in a single pass from the
+/// largest keeps down to the empty keep. That shares the sums that
+/// \c keep_value would repeat for each keep, so it is the faster way to value
+/// every keep; \c keep_value is the faster way to value a few.
+void TurnEvaluator::keep_values(const RollValues &values, KeepValues &out) noexcept
+{
+    constexpr int   first_full{static_cast<int>(keep_count - ScoreTable::size)};
+
+    std::copy(values.begin(), values.end(), out.begin() + first_full);
+    for (int keep{first_full - 1}; keep >= 0; --keep)
+    {
+        const auto &children{RerollTable::children(keep)};
+
+        out[keep] = (  out[children[0]] + out[children[1]] + out[children[2]]
+                     + out[children[3]] + out[children[4]] + out[children[5]]) / 6.0f;
+    }
+}
+
+///
+/// \brief TurnEvaluator::reroll_values Calculate the value of each roll when one reroll remains.
+/// \param values   The value of each roll after the dice are rerolled.
+/// \param out      Receives the value of each roll before the reroll, keeping the best dice.
+///
+void TurnEvaluator::reroll_values(const RollValues &values, RollValues &out) noexcept
+{
+    KeepValues  keep_ev;
+
+    keep_values(values, keep_ev);
+    for (size_t roll{0}; roll < out.size(); ++roll)
+    {
+        const auto  keeps{RerollTable::keeps(static_cast<int>(roll))};
+        float       best{keep_ev[keeps[0]]};
+
+        for (const auto keep : keeps)
+            best = std::max(best, keep_ev[keep]);
+        out[roll] = best;
+    }
+}
+
+///
+/// \brief TurnEvaluator::roll_expectation  Calculate the expected value of rolling all five dice.
+/// \param values   The value of each roll.
+///
+float TurnEvaluator::roll_expectation(const RollValues &values) noexcept
+{
+    KeepValues  keep_ev;
+
+    keep_values(values, keep_ev);
+    return keep_ev[0];
+}
@@ -0,0 +1,61 @@
+#ifndef TURNEVALUATOR_H
+#define TURNEVALUATOR_H
+
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "rerolltable.h"
+#include "scoretable.h"
+
+///
+/// \brief A value for each of the 252 distinct rolls, indexed as in \c ScoreTable.
+///
+using RollValues = std::array<float, ScoreTable::size>;
+
+///
+/// \brief Computes expected values over the rolls of a single turn.
+///
+/// The expected value of a keep is the average value of the rolls it can lead
+/// to, as given by \c RerollTable. The value of a roll with a reroll remaining
+/// is that of its best keep.
+///
+class TurnEvaluator
+{
+public:
+    ///
+    /// \brief The number of distinct keeps of zero to five dice.
+    ///
+    static constexpr size_t keep_count{RerollTable::keep_count};
+
+    ///
+    /// \brief The expected value of each keep, indexed by keep index.
+    ///
+    using KeepValues = std::array<float, keep_count>;
+
+    static float keep_value(const RollValues &values, int keep) noexcept;
+    static void keep_values(const RollValues &values, KeepValues &out) noexcept;
+    static void reroll_values(const RollValues &values, RollValues &out) noexcept;
+    static float roll_expectation(const RollValues &values) noexcept;
+};
+
+#endif // TURNEVALUATOR_H
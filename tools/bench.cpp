@@ -0,0 +1,514 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTime>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "config.h"
+#include "dice.h"
+#include "facegenerator.h"
+#include "gamescorer.h"
+#include "leaderboard.h"
+#include "packeddice.h"
+#include "scoresheet.h"
+
+namespace {
+///
+/// \brief Receives the results of benchmarked work so the compiler cannot discard it.
+///
+volatile std::uint64_t  sink;
+
+constexpr std::array<const char *, category_count>  category_names{
+    "aces", "twos", "threes", "fours", "fives", "sixes",
+    "three_of_a_kind", "four_of_a_kind", "full_house",
+    "small_straight", "large_straight", "yahtzee", "chance"
+};
+
+///
+/// \brief Runs benchmarks and collects their timings.
+///
+/// Each benchmark runs once untimed to warm caches, then a number of timed
+/// repetitions. A repetition performs a fixed number of operations, and its
+/// time per operation is one sample. The median of the samples is the figure
+/// to compare between runs; the spread shows how noisy the machine was.
+///
+class Bench
+{
+public:
+    Bench(unsigned repetitions, std::string filter)
+      : _repetitions{repetitions}
+      , _filter{std::move(filter)}
+    {}
+
+    ///
+    /// \brief  Determine whether a benchmark was selected to be run.
+    ///
+    bool selected(const std::string &name) const
+    {
+        return _filter.empty() || name.find(_filter) != std::string::npos;
+    }
+
+    ///
+    /// \brief  Time a benchmark, if it was selected.
+    /// \param name         The name of the benchmark.
+    /// \param size         The size of the data it works on, or zero.
+    /// \param operations   The number of operations in one repetition.
+    /// \param body         Performs one repetition.
+    ///
+    template <typename Body>
+    void run(const std::string &name, size_t size, size_t operations, Body &&body)
+    {
+        run(name, size, operations, [] {}, std::forward<Body>(body));
+    }
+
+    ///
+    /// \brief  Time a benchmark that needs fresh data for each repetition, if it was selected.
+    /// \param name         The name of the benchmark.
+    /// \param size         The size of the data it works on, or zero.
+    /// \param operations   The number of operations in one repetition.
+    /// \param setup        Prepares the data for one repetition. It is not timed.
+    /// \param body         Performs one repetition.
+    ///
+    template <typename Setup, typename Body>
+    void run(const std::string &name, size_t size, size_t operations, Setup &&setup, Body &&body)
+    {
+        if (!selected(name))
+            return;
+
+        std::vector<double> samples;
+
+        setup();
+        body();
+        for (unsigned r{0}; r < _repetitions; ++r)
+        {
+            setup();
+
+            const auto  start{std::chrono::steady_clock::now()};
+
+            body();
+
+            const std::chrono::duration<double, std::nano>  elapsed{std::chrono::steady_clock::now() - start};
+
+            samples.push_back(elapsed.count() / static_cast<double>(operations));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        const double    median{samples[samples.size() / 2]};
+
+        std::fprintf(stderr, "%-36s %12.1f ns/op\n", name.c_str(), median);
+
+        QJsonObject result;
+
+        result["name"] = QString::fromStdString(name);
+        if (size != 0)
+            result["size"] = static_cast<qint64>(size);
+        result["operations"] = static_cast<qint64>(operations);
+        result["repetitions"] = static_cast<int>(_repetitions);
+        result["ns_per_op_median"] = median;
+        result["ns_per_op_min"] = samples.front();
+        result["ns_per_op_max"] = samples.back();
+        result["ns_per_op_mean"] = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+        _results.append(result);
+    }
+
+    ///
+    /// \brief  Retrieve the results of the benchmarks run so far.
+    ///
+    const QJsonArray &results() const noexcept
+    {
+        return _results;
+    }
+
+private:
+    unsigned    _repetitions;
+    std::string _filter;
+    QJsonArray  _results;
+};
+
+///
+/// \brief  Benchmark scoring every roll of five dice in each category, and in all of them.
+///
+void bench_scorer(Bench &bench)
+{
+    std::vector<PackedDice> rolls;
+
+    for (int roll{0}; roll < 7776; ++roll)
+    {
+        PackedDice  dice;
+
+        for (size_t i{0}, r{static_cast<size_t>(roll)}; i < dice.size(); ++i, r /= 6)
+            dice.face(i, static_cast<int>(r % 6) + 1);
+        rolls.push_back(dice);
+    }
+
+    for (size_t c{0}; c < category_count; ++c)
+        bench.run(std::string{"gamescorer/"} + category_names[c], 0, rolls.size(), [&rolls, c]
+        {
+            std::uint64_t   total{0};
+
+            for (const auto &dice : rolls)
+                total += static_cast<std::uint64_t>(GameScorer{dice}.score(static_cast<Category>(c)));
+            sink = sink + total;
+        });
+
+    bench.run("gamescorer/all_categories", 0, rolls.size(), [&rolls]
+    {
+        std::uint64_t   total{0};
+
+        for (const auto &dice : rolls)
+        {
+            const GameScorer    scorer{dice};
+
+            for (size_t c{0}; c < category_count; ++c)
+                total += static_cast<std::uint64_t>(scorer.score(static_cast<Category>(c)));
+        }
+        sink = sink + total;
+    });
+}
+
+///
+/// \brief  Benchmark rolling the dice, animated and not.
+///
+/// An animated roll works out all of its bounce frames at once and plays
+/// them back on a timer. Finishing the roll at once shows the last frame,
+/// so the benchmark covers the work of a roll without the time spent
+/// waiting between frames.
+///
+void bench_dice(Bench &bench)
+{
+    constexpr size_t        roll_count{10000};
+    FaceGenerator           gen{1};
+    std::vector<PackedDice> results;
+
+    for (size_t r{0}; r < roll_count; ++r)
+    {
+        PackedDice  dice;
+
+        for (size_t i{0}; i < dice.size(); ++i)
+            dice.face(i, gen.face());
+        results.emplace_back(dice.encoding(), static_cast<std::uint8_t>(gen() % 31));
+    }
+
+    Dice    dice;
+
+    for (const bool animated : {true, false})
+    {
+        dice.animated(animated);
+        bench.run(animated ? "dice/roll" : "dice/roll_turbo", 0, results.size(), [&dice, &results]
+        {
+            for (const auto &result : results)
+            {
+                dice.roll(result);
+                dice.finish();
+            }
+            sink = sink + dice.packed().encoding();
+        });
+    }
+}
+
+///
+/// \brief  Benchmark the recalculation of the totals when a score changes.
+///
+/// Each operation scores one cell and reads back everything a score column
+/// shows, as the columns do when they refresh.
+///
+void bench_sheet(Bench &bench)
+{
+    constexpr size_t    cell_count{ScoreSheet::column_count * category_count};
+    FaceGenerator       gen{2};
+    std::vector<int>    scores;
+
+    for (size_t n{0}; n < cell_count; ++n)
+        scores.push_back(static_cast<int>(gen() % 31));
+
+    bench.run("scoresheet/score_changed", 0, 1000 * cell_count, [&scores]
+    {
+        ScoreSheet      sheet;
+        std::uint64_t   total{0};
+
+        for (int pass{0}; pass < 1000; ++pass)
+        {
+            sheet.clear();
+            for (size_t col{0}; col < ScoreSheet::column_count; ++col)
+                for (size_t cat{0}; cat < category_count; ++cat)
+                {
+                    sheet.set(col, static_cast<Category>(cat), scores[col * category_count + cat]);
+
+                    const auto  totals{sheet.totals(col)};
+
+                    total += static_cast<std::uint64_t>(totals.total + sheet.grand_total());
+                }
+        }
+        sink = sink + total;
+    });
+}
+
+///
+/// \brief  Write a configuration file holding a number of high scores.
+/// \param path             The location of the file.
+/// \param count            The number of high scores.
+/// \param max_high_scores  The most high scores the file allows.
+///
+bool write_config(const QString &path, size_t count, size_t max_high_scores)
+{
+    FaceGenerator       gen{count};
+    const QDateTime     start{QDate{2023, 1, 1}, QTime{0, 0}};
+    QJsonArray          scores;
+    std::vector<int>    values;
+
+    for (size_t n{0}; n < count; ++n)
+        values.push_back(static_cast<int>(100 + gen() % 1400));
+    std::sort(values.begin(), values.end(), std::greater<int>{});
+    for (size_t n{0}; n < count; ++n)
+    {
+        QJsonObject score;
+
+        score["score"] = values[n];
+        score["when"] = start.addSecs(static_cast<qint64>(gen() % 100000000)).toString(Qt::ISODate);
+        score["name"] = QString{"Player %1"}.arg(gen() % 1000);
+        scores.append(score);
+    }
+
+    QJsonObject obj;
+
+    obj["last_used_name"] = "Player 1";
+    obj["player_id"] = QString::number(0x123456789abcdefull, 16);
+    obj["max_high_scores"] = static_cast<int>(max_high_scores);
+    obj["high_scores"] = scores;
+
+    QFile   file{path};
+
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(QJsonDocument{obj}.toJson()) >= 0;
+}
+
+///
+/// \brief  Benchmark loading and saving the configuration, and adding high scores to it.
+/// \param dir  A directory for the configuration files.
+///
+void bench_config(Bench &bench, const QString &dir)
+{
+    for (const size_t count : {size_t{10}, size_t{1000}, size_t{100000}})
+    {
+        const QString   path{QString{"%1/config-%2.json"}.arg(dir).arg(count)};
+        const size_t    operations{std::max<size_t>(1, 10000 / count)};
+        const auto      suffix{"/" + std::to_string(count)};
+
+        if (!bench.selected("config/") || !write_config(path, count, count))
+            continue;
+
+        bench.run("config/load" + suffix, count, operations, [&path, operations]
+        {
+            for (size_t n{0}; n < operations; ++n)
+            {
+                Config  config{path};
+
+                config.load();
+                sink = sink + config.hi_scores().size();
+            }
+        });
+
+        Config  config{path};
+
+        config.load();
+        // Saves are written in the background; waiting for each times the write itself.
+        bench.run("config/save" + suffix, count, operations, [&config, operations]
+        {
+            for (size_t n{0}; n < operations; ++n)
+            {
+                config.save();
+                config.wait_for_saves();
+            }
+        });
+
+        // Scores spread over the range of those held, so that most are
+        // inserted in the middle of the collection. Each repetition starts
+        // from the same configuration, so the collection does not grow from
+        // one to the next.
+        FaceGenerator           gen{3};
+        std::vector<int>        scores;
+        const QDateTime         when{QDate{2024, 1, 1}, QTime{0, 0}};
+        const QString           name{"Player 2"};
+        std::unique_ptr<Config> fresh;
+
+        for (size_t n{0}; n < 1000; ++n)
+            scores.push_back(static_cast<int>(100 + gen() % 1400));
+        bench.run("config/add_high_score" + suffix, count, scores.size(),
+                  [&fresh, &path, count]
+                  {
+                      fresh.reset();
+                      QFile::remove(path + ".scores");
+                      write_config(path, count, count);
+                      fresh = std::make_unique<Config>(path);
+                      fresh->load();
+                      fresh->wait_for_saves();
+                  },
+                  [&fresh, &scores, &when, &name]
+                  {
+                      for (const int score : scores)
+                          sink = sink + fresh->add_high_score(score, name, when);
+                  });
+    }
+
+    // A long history with the default number of high scores: loading reads
+    // the configuration file alone, however many scores the leaderboard holds.
+    constexpr size_t    history_size{1000000};
+    constexpr size_t    default_high_scores{20};
+    const QString       path{QString{"%1/config-history.json"}.arg(dir)};
+
+    if (!bench.selected("config/load_history") || !write_config(path, 0, default_high_scores))
+        return;
+
+    {
+        FaceGenerator   gen{4};
+        Leaderboard     leaderboard{QFile::encodeName(path + ".scores").toStdString()};
+
+        leaderboard.clear();
+        for (size_t n{0}; n < history_size; ++n)
+            leaderboard.add(Leaderboard::Entry{static_cast<std::int32_t>(100 + gen() % 1400),
+                                               static_cast<std::int64_t>(1672531200000 + gen() % 100000000000),
+                                               "Player " + std::to_string(gen() % 1000)});
+
+        // The first load finds the leaderboard changed, and saves its high scores.
+        Config  config{path};
+
+        config.load();
+        config.wait_for_saves();
+    }
+
+    bench.run("config/load_history/" + std::to_string(history_size), history_size, 100, [&path]
+    {
+        for (size_t n{0}; n < 100; ++n)
+        {
+            Config  config{path};
+
+            config.load();
+            sink = sink + config.hi_scores().size();
+        }
+    });
+}
+
+void usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-r repetitions] [--filter text] [-o file]\n"
+                 "  -r repetitions      timed repetitions of each benchmark, default 7\n"
+                 "  --filter text       run only the benchmarks whose names contain the text\n"
+                 "  -o file             write the results to a JSON file, default standard output\n",
+                 program);
+}
+}   // anonymous namespace
+
+///
+/// \brief Time the game's hot paths and write the results as JSON.
+///
+/// A summary goes to standard error as each benchmark finishes.
+///
+int main(int argc, char *argv[])
+{
+    QCoreApplication    app{argc, argv};    // the dice need an event dispatcher for their timer
+    unsigned            repetitions{7};
+    std::string         filter;
+    std::string         out_path;
+
+    for (int i{1}; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            repetitions = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            out_path = argv[++i];
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (repetitions == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    QTemporaryDir   dir;
+
+    if (!dir.isValid())
+    {
+        std::fprintf(stderr, "cannot create a temporary directory\n");
+        return EXIT_FAILURE;
+    }
+
+    Bench   bench{repetitions, filter};
+
+    bench_scorer(bench);
+    bench_dice(bench);
+    bench_sheet(bench);
+    bench_config(bench, dir.path());
+
+    QJsonObject report;
+
+    report["tool"] = "tripleytz-bench";
+    report["qt_version"] = qVersion();
+    report["time"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["repetitions"] = static_cast<int>(repetitions);
+    report["results"] = bench.results();
+
+    const QByteArray    json{QJsonDocument{report}.toJson()};
+
+    if (out_path.empty())
+    {
+        std::fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+        return EXIT_SUCCESS;
+    }
+
+    std::FILE  *out{std::fopen(out_path.c_str(), "w")};
+
+    if (!out)
+    {
+        std::fprintf(stderr, "cannot write %s\n", out_path.c_str());
+        return EXIT_FAILURE;
+    }
+    std::fwrite(json.constData(), 1, static_cast<size_t>(json.size()), out);
+    std::fclose(out);
+
+    return EXIT_SUCCESS;
+}
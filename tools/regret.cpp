@@ -0,0 +1,578 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gameengine.h"
+#include "journal.h"
+#include "keepadvisor.h"
+#include "triplesolver.h"
+
+namespace {
+constexpr const char   *category_names[category_count]{
+    "aces", "twos", "threes", "fours", "fives", "sixes",
+    "three-of-a-kind", "four-of-a-kind", "full-house",
+    "small-straight", "large-straight", "yahtzee", "chance"
+};
+
+///
+/// \brief A choice made in a game, valued against the strategy.
+///
+struct Decision
+{
+    size_t          step;       // the number of steps taken in the game when the choice was made
+    std::uint16_t   dice;       // encoding of the dice the choice was made on
+    std::uint8_t    turn;       // zero-based
+    std::uint8_t    roll;       // rolls made in the turn so far
+    bool            is_cell;    // a cell to score in, rather than dice to keep
+    std::uint8_t    chosen;     // the keep mask, or the cell as column times 13 plus category
+    std::uint8_t    best;
+    float           regret;     // expected points lost by the choice
+};
+
+///
+/// \brief The decisions of one player's games, summed.
+///
+struct PlayerSummary
+{
+    std::uint64_t                               games{0};
+    std::uint64_t                               score{0};
+    std::uint64_t                               keeps{0};
+    double                                      keep_regret{0.0};
+    std::array<std::uint64_t, GameEngine::column_count> cells{};       // by the column scored in
+    std::array<double, GameEngine::column_count>        cell_regret{};
+
+    void merge(const PlayerSummary &other)
+    {
+        games += other.games;
+        score += other.score;
+        keeps += other.keeps;
+        keep_regret += other.keep_regret;
+        for (size_t c{0}; c < cells.size(); ++c)
+        {
+            cells[c] += other.cells[c];
+            cell_regret[c] += other.cell_regret[c];
+        }
+    }
+
+    double total_regret() const noexcept
+    {
+        return keep_regret + cell_regret[0] + cell_regret[1] + cell_regret[2];
+    }
+};
+
+using Summaries = std::unordered_map<std::uint64_t, PlayerSummary>;
+
+///
+/// \brief Replays journalled games and values the decisions made in them.
+///
+/// Each thread has an analyzer of its own. Decisions are valued from the
+/// advisor's tables for the state of the score sheet at the start of each
+/// turn, which are computed once per turn and shared by every decision made
+/// in it.
+///
+class Analyzer
+{
+public:
+    explicit Analyzer(std::unique_ptr<KeepAdvisor> advisor)
+      : _advisor{std::move(advisor)}
+    {}
+
+    void analyze_file(const std::string &path, Summaries &summaries, std::string *out);
+
+    std::uint64_t   games{0};           // complete games analyzed
+    std::uint64_t   skipped{0};         // incomplete or inconsistent games
+    std::uint64_t   decisions{0};
+
+private:
+    bool replay(const Journal::Record *first, const Journal::Record *last);
+    void decide_keep(std::uint8_t mask);
+    void decide_cell(std::uint8_t cell);
+    void write(std::uint64_t player, std::string &out) const;
+
+    std::unique_ptr<KeepAdvisor>    _advisor;
+    GameEngine                      _game;
+    std::vector<Decision>           _decisions;
+    TripleSolver::CellValues        _cells;
+};
+
+///
+/// \brief Analyzer::analyze_file   Analyze every complete game in a journal file.
+/// \param path         The location of the journal file.
+/// \param summaries    The player summaries to add the games to.
+/// \param out          The per-decision lines are appended here, or null without a decisions file.
+///
+void Analyzer::analyze_file(const std::string &path, Summaries &summaries, std::string *out)
+{
+    std::uint64_t               player;
+    std::vector<Journal::Record> records;
+
+    if (!Journal::read(path, player, records))
+    {
+        std::fprintf(stderr, "cannot read journal %s\n", path.c_str());
+        return;
+    }
+
+    const auto  is_start{[](const Journal::Record &record) { return record.kind == Journal::Kind::Game; }};
+    auto        first{std::find_if(records.begin(), records.end(), is_start)};
+
+    while (first != records.end())
+    {
+        const auto  last{std::find_if(first + 1, records.end(), is_start)};
+
+        if (replay(&*first, &*first + (last - first)))
+        {
+            auto   &summary{summaries[player]};
+
+            ++games;
+            decisions += _decisions.size();
+            ++summary.games;
+            summary.score += static_cast<std::uint64_t>(_game.grand_total());
+            for (const auto &decision : _decisions)
+                if (decision.is_cell)
+                {
+                    const auto  column{decision.chosen / category_count};
+
+                    ++summary.cells[column];
+                    summary.cell_regret[column] += decision.regret;
+                }
+                else
+                {
+                    ++summary.keeps;
+                    summary.keep_regret += decision.regret;
+                }
+            if (out)
+                write(player, *out);
+        }
+        else
+        {
+            ++skipped;
+        }
+        first = last;
+    }
+}
+
+///
+/// \brief Analyzer::replay Replay one game from its journal records, valuing its decisions.
+/// \param first    The game's Game record.
+/// \param last     One past the game's last record.
+/// \return true if the game was played from its start to its end, and every
+///         roll matched the journal.
+///
+/// Decisions later undone and not redone are dropped, so only the choices
+/// that stood at the end of the game are kept.
+bool Analyzer::replay(const Journal::Record *first, const Journal::Record *last)
+{
+    if (last - first < 2 || first[1].kind != Journal::Kind::GameId || first[1].cell != 0)
+        return false;
+    if (first->cell > static_cast<std::uint8_t>(FaceGenerator::Engine::Philox))
+        return false;
+
+    _game = GameEngine{first->value, static_cast<FaceGenerator::Engine>(first->cell)};
+    _game.new_game(first->value, first[1].value);
+    _decisions.clear();
+
+    // A new step forgets any undone steps, and the decisions made at them.
+    const auto  discard_undone{[this]
+    {
+        const auto  taken{_game.steps_taken()};
+
+        while (!_decisions.empty() && _decisions.back().step >= taken)
+            _decisions.pop_back();
+    }};
+
+    for (auto record{first + 2}; record != last; ++record)
+        switch (record->kind)
+        {
+        case Journal::Kind::Roll:
+            if (!_game.can_roll())
+                return false;
+            discard_undone();
+            if (_game.has_rolled())
+                decide_keep(_game.dice().keep_mask());
+            if (_game.roll().encoding() != record->value)
+                return false;
+            break;
+
+        case Journal::Kind::Keep:
+            if (!_game.keep_mask(record->keep_mask))
+                return false;
+            break;
+
+        case Journal::Kind::Score:
+        {
+            const size_t    column{record->cell / category_count};
+            const auto      category{static_cast<Category>(record->cell % category_count)};
+
+            if (!_game.can_score(column, category))
+                return false;
+            discard_undone();
+            if (_game.can_roll())
+                decide_keep(0x1F);     // scoring with rolls left is keeping all five dice
+            decide_cell(record->cell);
+            _game.score(column, category);
+            break;
+        }
+
+        case Journal::Kind::Undo:
+            _game.undo();
+            break;
+
+        case Journal::Kind::Redo:
+            _game.redo();
+            break;
+
+        case Journal::Kind::End:
+            _decisions.erase(std::remove_if(_decisions.begin(), _decisions.end(),
+                                            [taken = _game.steps_taken()](const Decision &d) { return d.step >= taken; }),
+                             _decisions.end());
+            return _game.game_over();
+
+        default:
+            return false;
+        }
+
+    return false;
+}
+
+///
+/// \brief Analyzer::decide_keep    Value the dice kept before a reroll.
+/// \param mask The dice kept.
+///
+void Analyzer::decide_keep(std::uint8_t mask)
+{
+    const auto  ranked{_advisor->rank(_game)};
+    const auto  chosen{std::find_if(ranked.begin(), ranked.end(), [mask](const KeepAdvice &advice) { return advice.mask == mask; })};
+
+    _decisions.push_back(Decision{_game.steps_taken(),
+                                  _game.dice().encoding(),
+                                  static_cast<std::uint8_t>(GameEngine::max_plays - _game.plays_left()),
+                                  static_cast<std::uint8_t>(GameEngine::max_rolls - _game.rolls_left()),
+                                  false,
+                                  mask,
+                                  ranked.front().mask,
+                                  std::max(0.0f, ranked.front().value - chosen->value)});
+}
+
+///
+/// \brief Analyzer::decide_cell    Value the cell the dice were scored in.
+/// \param cell The cell, as column times 13 plus category.
+///
+void Analyzer::decide_cell(std::uint8_t cell)
+{
+    _advisor->cell_values(_game, _cells);
+
+    const auto  best{static_cast<size_t>(std::max_element(_cells.begin(), _cells.end()) - _cells.begin())};
+
+    _decisions.push_back(Decision{_game.steps_taken(),
+                                  _game.dice().encoding(),
+                                  static_cast<std::uint8_t>(GameEngine::max_plays - _game.plays_left()),
+                                  static_cast<std::uint8_t>(GameEngine::max_rolls - _game.rolls_left()),
+                                  true,
+                                  cell,
+                                  static_cast<std::uint8_t>(best),
+                                  std::max(0.0f, _cells[best] - _cells[cell])});
+}
+
+///
+/// \brief  Describe a keep mask by the faces it keeps, or a cell by its multiplier and category.
+///
+std::string describe(const Decision &decision, std::uint8_t choice)
+{
+    if (decision.is_cell)
+        return "x" + std::to_string(choice / category_count + 1) + " " + category_names[choice % category_count];
+
+    const PackedDice    dice{decision.dice};
+    std::string         kept;
+
+    for (size_t i{0}; i < dice.size(); ++i)
+        if (choice & (1u << i))
+            kept += static_cast<char>('0' + dice.face(i));
+    std::sort(kept.begin(), kept.end());
+
+    return kept.empty() ? "-" : kept;
+}
+
+///
+/// \brief Analyzer::write  Append a line for each decision of the game just replayed.
+///
+void Analyzer::write(std::uint64_t player, std::string &out) const
+{
+    if (!out.capacity())
+        return;
+
+    char    line[160];
+
+    for (const auto &decision : _decisions)
+    {
+        const int   length{std::snprintf(line, sizeof(line), "%016llx,%llu,%llu,%u,%u,%s,%s,%s,%.3f\n",
+                                         static_cast<unsigned long long>(player),
+                                         static_cast<unsigned long long>(_game.seed()),
+                                         static_cast<unsigned long long>(_game.game_id()),
+                                         decision.turn + 1u,
+                                         static_cast<unsigned>(decision.roll),
+                                         decision.is_cell ? "cell" : "keep",
+                                         describe(decision, decision.chosen).c_str(),
+                                         describe(decision, decision.best).c_str(),
+                                         static_cast<double>(decision.regret))};
+
+        out.append(line, static_cast<size_t>(std::min<int>(length, sizeof(line) - 1)));
+    }
+}
+
+///
+/// \brief  Collect the journal files named on the command line, looking inside directories.
+///
+bool collect_journals(const std::vector<std::string> &names, std::vector<std::string> &paths)
+{
+    for (const auto &name : names)
+    {
+        std::error_code ec;
+
+        if (std::filesystem::is_directory(name, ec))
+        {
+            for (const auto &entry : std::filesystem::recursive_directory_iterator{name, ec})
+                if (entry.is_regular_file() && entry.path().extension() == ".tyj")
+                    paths.push_back(entry.path().string());
+        }
+        else if (std::filesystem::is_regular_file(name, ec))
+        {
+            paths.push_back(name);
+        }
+        else
+        {
+            std::fprintf(stderr, "cannot find %s\n", name.c_str());
+            return false;
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    return true;
+}
+
+void usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "usage: %s --column-file file [--triple-file file] [-j threads] [--decisions file] [--players file] journal...\n"
+                 "  --column-file file  column strategy file written by tripleytz-solve\n"
+                 "  --triple-file file  Triple strategy file, default triple.tbl beside the column file\n"
+                 "  -j threads          number of threads, default one per hardware thread\n"
+                 "  --decisions file    write the regret of every decision to a CSV file\n"
+                 "  --players file      write a summary of each player to a CSV file\n"
+                 "  journal             a journal file, or a directory searched for .tyj files\n",
+                 program);
+}
+}   // anonymous namespace
+
+///
+/// \brief Value the decisions in journalled games against the optimal strategy.
+///
+int main(int argc, char *argv[])
+{
+    unsigned                    threads{0};
+    std::string                 column_path;
+    std::string                 triple_path;
+    std::string                 decisions_path;
+    std::string                 players_path;
+    std::vector<std::string>    names;
+
+    for (int i{1}; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--column-file") == 0 && i + 1 < argc)
+            column_path = argv[++i];
+        else if (std::strcmp(argv[i], "--triple-file") == 0 && i + 1 < argc)
+            triple_path = argv[++i];
+        else if (std::strcmp(argv[i], "--decisions") == 0 && i + 1 < argc)
+            decisions_path = argv[++i];
+        else if (std::strcmp(argv[i], "--players") == 0 && i + 1 < argc)
+            players_path = argv[++i];
+        else if (argv[i][0] == '-')
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else
+            names.push_back(argv[i]);
+    }
+    if (column_path.empty() || names.empty())
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (triple_path.empty())
+        triple_path = std::filesystem::path{column_path}.replace_filename("triple.tbl").string();
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::string>    paths;
+
+    if (!collect_journals(names, paths))
+        return EXIT_FAILURE;
+
+    std::vector<std::unique_ptr<Analyzer>>  analyzers;
+
+    for (unsigned t{0}; t < threads; ++t)
+    {
+        auto    advisor{std::make_unique<KeepAdvisor>()};
+
+        if (!advisor->load(column_path, triple_path))
+        {
+            std::fprintf(stderr, "cannot read %s\n", column_path.c_str());
+            return EXIT_FAILURE;
+        }
+        analyzers.push_back(std::make_unique<Analyzer>(std::move(advisor)));
+    }
+
+    std::FILE  *decisions_file{nullptr};
+
+    if (!decisions_path.empty())
+    {
+        decisions_file = std::fopen(decisions_path.c_str(), "w");
+        if (!decisions_file)
+        {
+            std::fprintf(stderr, "cannot write %s\n", decisions_path.c_str());
+            return EXIT_FAILURE;
+        }
+        std::fputs("player,seed,game,turn,roll,decision,chosen,best,regret\n", decisions_file);
+    }
+
+    constexpr size_t            flush_size{size_t{1} << 20};
+    std::atomic<size_t>         next{0};
+    std::mutex                  out_mutex;
+    std::vector<Summaries>      summaries(threads);
+    std::vector<std::thread>    pool;
+
+    auto    worker{[&](unsigned t)
+    {
+        std::string out;
+
+        if (decisions_file)
+            out.reserve(2 * flush_size);
+        for (size_t f{next++}; f < paths.size(); f = next++)
+        {
+            analyzers[t]->analyze_file(paths[f], summaries[t], decisions_file ? &out : nullptr);
+            if (out.size() >= flush_size)
+            {
+                std::lock_guard lock{out_mutex};
+
+                std::fwrite(out.data(), 1, out.size(), decisions_file);
+                out.clear();
+            }
+        }
+        if (!out.empty())
+        {
+            std::lock_guard lock{out_mutex};
+
+            std::fwrite(out.data(), 1, out.size(), decisions_file);
+        }
+    }};
+
+    const auto  start{std::chrono::steady_clock::now()};
+
+    for (unsigned t{1}; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &t : pool)
+        t.join();
+
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+    if (decisions_file)
+        std::fclose(decisions_file);
+
+    Summaries       players;
+    PlayerSummary   total;
+    std::uint64_t   games{0};
+    std::uint64_t   skipped{0};
+    std::uint64_t   decisions{0};
+
+    for (unsigned t{0}; t < threads; ++t)
+    {
+        games += analyzers[t]->games;
+        skipped += analyzers[t]->skipped;
+        decisions += analyzers[t]->decisions;
+        for (const auto &[player, summary] : summaries[t])
+            players[player].merge(summary);
+    }
+    for (const auto &[player, summary] : players)
+        total.merge(summary);
+
+    if (!players_path.empty())
+    {
+        std::vector<std::uint64_t>  ids;
+
+        for (const auto &entry : players)
+            ids.push_back(entry.first);
+        std::sort(ids.begin(), ids.end());
+
+        std::FILE  *file{std::fopen(players_path.c_str(), "w")};
+
+        if (!file)
+        {
+            std::fprintf(stderr, "cannot write %s\n", players_path.c_str());
+            return EXIT_FAILURE;
+        }
+        std::fputs("player,games,mean_score,regret_per_game,keep_regret_per_game,x1_regret_per_game,x2_regret_per_game,x3_regret_per_game\n", file);
+        for (const auto id : ids)
+        {
+            const auto     &summary{players[id]};
+            const double    n{static_cast<double>(summary.games)};
+
+            std::fprintf(file, "%016llx,%llu,%.2f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+                         static_cast<unsigned long long>(id), static_cast<unsigned long long>(summary.games),
+                         static_cast<double>(summary.score) / n, summary.total_regret() / n, summary.keep_regret / n,
+                         summary.cell_regret[0] / n, summary.cell_regret[1] / n, summary.cell_regret[2] / n);
+        }
+        std::fclose(file);
+    }
+
+    const double    n{static_cast<double>(std::max<std::uint64_t>(games, 1))};
+
+    std::printf("journals:   %zu\n", paths.size());
+    std::printf("players:    %zu\n", players.size());
+    std::printf("games:      %llu analyzed, %llu skipped, on %u threads in %.2f s\n",
+                static_cast<unsigned long long>(games), static_cast<unsigned long long>(skipped), threads, elapsed.count());
+    std::printf("throughput: %.0f games/s\n", static_cast<double>(games) / elapsed.count());
+    std::printf("decisions:  %llu\n", static_cast<unsigned long long>(decisions));
+    std::printf("mean score: %.2f\n", static_cast<double>(total.score) / n);
+    std::printf("regret per game:\n");
+    std::printf("  total     %8.3f\n", total.total_regret() / n);
+    std::printf("  keeps     %8.3f\n", total.keep_regret / n);
+    for (size_t c{0}; c < GameEngine::column_count; ++c)
+        std::printf("  x%zu cells  %8.3f\n", c + 1, total.cell_regret[c] / n);
+
+    return EXIT_SUCCESS;
+}
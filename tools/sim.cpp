@@ -0,0 +1,473 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "facegenerator.h"
+#include "gameengine.h"
+#include "keepadvisor.h"
+#include "scoretable.h"
+#include "triplesolver.h"
+
+namespace {
+///
+/// \brief Chooses the dice to keep and the cells to score during a game.
+///
+class Strategy
+{
+public:
+    virtual ~Strategy() = default;
+
+    ///
+    /// \brief  Prepare for a new game.
+    /// \param seed     The master seed of the run.
+    /// \param game_id  The id of the game.
+    ///
+    virtual void new_game(std::uint64_t seed, std::uint64_t game_id)
+    {
+        static_cast<void>(seed);
+        static_cast<void>(game_id);
+    }
+
+    ///
+    /// \brief  Choose the dice to keep before the next roll.
+    /// \return The mask of dice to keep. Keeping all five ends the turn.
+    ///
+    virtual std::uint8_t keep(const GameEngine &game) = 0;
+
+    ///
+    /// \brief  Choose the cell to score the dice in.
+    ///
+    virtual TripleCell cell(const GameEngine &game) = 0;
+};
+
+///
+/// \brief Keeps random dice and scores in a random open cell.
+///
+/// Its choices come from a stream of their own for each game, so they are as
+/// reproducible as the dice.
+///
+class RandomStrategy : public Strategy
+{
+public:
+    void new_game(std::uint64_t seed, std::uint64_t game_id) override
+    {
+        _gen.seed(~seed, game_id);
+    }
+
+    std::uint8_t keep(const GameEngine &) override
+    {
+        return static_cast<std::uint8_t>(_gen() & 0x1F);
+    }
+
+    TripleCell cell(const GameEngine &game) override
+    {
+        std::array<TripleCell, GameEngine::column_count * category_count>   open;
+        size_t  count{0};
+
+        for (size_t c{0}; c < GameEngine::column_count; ++c)
+            for (size_t k{0}; k < category_count; ++k)
+                if (game.can_score(c, static_cast<Category>(k)))
+                    open[count++] = TripleCell{c, static_cast<Category>(k)};
+
+        return open[std::uniform_int_distribution<size_t>{0, count - 1}(_gen)];
+    }
+
+private:
+    FaceGenerator   _gen;
+};
+
+///
+/// \brief Chases the most common face and takes the highest score on offer.
+///
+class GreedyStrategy : public Strategy
+{
+public:
+    std::uint8_t keep(const GameEngine &game) override
+    {
+        const auto &dice{game.dice()};
+        int         face{6};
+
+        for (int f{5}; f >= 1; --f)
+            if (dice.pip_count(f) > dice.pip_count(face))
+                face = f;
+
+        std::uint8_t    mask{0};
+
+        for (size_t d{0}; d < dice.size(); ++d)
+            if (dice.face(d) == face)
+                mask |= static_cast<std::uint8_t>(1u << d);
+
+        return mask;
+    }
+
+    TripleCell cell(const GameEngine &game) override
+    {
+        const auto &scores{ScoreTable::scores(game.dice())};
+        TripleCell  best_cell{0, Category::Chance};
+        int         best{-1};
+
+        for (size_t c{0}; c < GameEngine::column_count; ++c)
+            for (size_t k{0}; k < category_count; ++k)
+            {
+                const auto  category{static_cast<Category>(k)};
+                const int   total{scores[k] * GameEngine::multiplier(c)};
+
+                if (total > best && game.can_score(c, category))
+                {
+                    best = total;
+                    best_cell = TripleCell{c, category};
+                }
+            }
+
+        return best_cell;
+    }
+};
+
+///
+/// \brief Plays by the strategy in a pair of strategy files.
+///
+class OptimalStrategy : public Strategy
+{
+public:
+    explicit OptimalStrategy(std::unique_ptr<KeepAdvisor> advisor)
+      : _advisor{std::move(advisor)}
+    {}
+
+    std::uint8_t keep(const GameEngine &game) override
+    {
+        return _advisor->rank(game).front().mask;
+    }
+
+    TripleCell cell(const GameEngine &game) override
+    {
+        return _advisor->best_cell(game);
+    }
+
+private:
+    std::unique_ptr<KeepAdvisor>    _advisor;
+};
+
+///
+/// \brief Scores gathered by one thread.
+///
+struct Results
+{
+    ///
+    /// \brief A game and its final score.
+    ///
+    struct Game
+    {
+        int             score;
+        std::uint64_t   id;
+    };
+
+    std::vector<std::uint64_t>  histogram;      // games by final score
+    std::uint64_t               games{0};
+    Game                        lowest{std::numeric_limits<int>::max(), 0};
+    Game                        highest{-1, 0};
+
+    ///
+    /// \brief  Record a game's final score.
+    ///
+    /// Of games with the same extreme score, the one with the lowest id is
+    /// kept, so the extremes do not depend on how games were shared out.
+    void add(const Game &game)
+    {
+        if (static_cast<size_t>(game.score) >= histogram.size())
+            histogram.resize(game.score + 1);
+        ++histogram[game.score];
+        add_extreme(game, game);
+    }
+
+    ///
+    /// \brief  Add the results gathered by another thread.
+    ///
+    void merge(const Results &other)
+    {
+        if (other.histogram.size() > histogram.size())
+            histogram.resize(other.histogram.size());
+        for (size_t score{0}; score < other.histogram.size(); ++score)
+            histogram[score] += other.histogram[score];
+        games += other.games;
+        if (other.games)
+            add_extreme(other.lowest, other.highest);
+    }
+
+private:
+    void add_extreme(const Game &low, const Game &high)
+    {
+        if (low.score < lowest.score || (low.score == lowest.score && low.id < lowest.id))
+            lowest = low;
+        if (high.score > highest.score || (high.score == highest.score && high.id < highest.id))
+            highest = high;
+    }
+};
+
+///
+/// \brief Play one complete game.
+/// \param game     The engine to play on.
+/// \param strategy The strategy to play by.
+/// \param seed     The master seed of the run.
+/// \param game_id  The id of the game, which with the seed decides its dice.
+/// \return The final score.
+///
+int play(GameEngine &game, Strategy &strategy, std::uint64_t seed, std::uint64_t game_id)
+{
+    game.new_game(seed, game_id);
+    strategy.new_game(seed, game_id);
+    while (!game.game_over())
+    {
+        game.roll();
+        while (game.can_roll())
+        {
+            const auto  mask{strategy.keep(game)};
+
+            if (mask == 0x1F)
+                break;
+            game.keep_mask(mask);
+            game.roll();
+        }
+
+        const auto  cell{strategy.cell(game)};
+
+        game.score(cell.column, cell.category);
+    }
+
+    return game.grand_total();
+}
+
+int percentile(const std::vector<std::uint64_t> &histogram, std::uint64_t games, double fraction)
+{
+    const auto      target{static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(games)))};
+    std::uint64_t   seen{0};
+
+    for (size_t score{0}; score < histogram.size(); ++score)
+    {
+        seen += histogram[score];
+        if (seen >= std::max<std::uint64_t>(target, 1))
+            return static_cast<int>(score);
+    }
+
+    return static_cast<int>(histogram.size()) - 1;
+}
+
+void usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-n games] [-j threads] [--seed seed] [--rng name] [--strategy name] [--column-file file] [--triple-file file]\n"
+                 "  -n games            number of games to play, default 100000\n"
+                 "  -j threads          number of threads, default one per hardware thread\n"
+                 "  --seed seed         master seed, default taken from the clock\n"
+                 "  --rng name          xoshiro, pcg, mt or philox to roll the dice with, default xoshiro\n"
+                 "  --strategy name     random, greedy or optimal, default greedy\n"
+                 "  --column-file file  column strategy file, required by the optimal strategy\n"
+                 "  --triple-file file  Triple strategy file for the optimal strategy, default triple.tbl beside the column file\n",
+                 program);
+}
+}   // anonymous namespace
+
+///
+/// \brief Play many games of Triple Yahtzee with a strategy and report the scores.
+///
+int main(int argc, char *argv[])
+{
+    std::uint64_t   games{100000};
+    unsigned        threads{0};
+    std::uint64_t   seed{static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())};
+    std::string     strategy_name{"greedy"};
+    std::string     rng_name{"xoshiro"};
+    std::string     column_path;
+    std::string     triple_path;
+
+    for (int i{1}; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            games = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--rng") == 0 && i + 1 < argc)
+            rng_name = argv[++i];
+        else if (std::strcmp(argv[i], "--strategy") == 0 && i + 1 < argc)
+            strategy_name = argv[++i];
+        else if (std::strcmp(argv[i], "--column-file") == 0 && i + 1 < argc)
+            column_path = argv[++i];
+        else if (std::strcmp(argv[i], "--triple-file") == 0 && i + 1 < argc)
+            triple_path = argv[++i];
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (strategy_name != "random" && strategy_name != "greedy" && strategy_name != "optimal")
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const auto  rng{FaceGenerator::engine_from_name(rng_name)};
+
+    if (!rng)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const auto  engine{*rng};
+    if (strategy_name == "optimal" && column_path.empty())
+    {
+        std::fprintf(stderr, "the optimal strategy needs --column-file\n");
+        return EXIT_FAILURE;
+    }
+    if (triple_path.empty())
+        triple_path = std::filesystem::path{column_path}.replace_filename("triple.tbl").string();
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Each thread gets its own strategy; only the optimal one can fail to build.
+    auto    make_strategy{[&]() -> std::unique_ptr<Strategy>
+    {
+        if (strategy_name == "random")
+            return std::make_unique<RandomStrategy>();
+        if (strategy_name == "greedy")
+            return std::make_unique<GreedyStrategy>();
+
+        auto    advisor{std::make_unique<KeepAdvisor>()};
+
+        if (!advisor->load(column_path, triple_path))
+            return nullptr;
+        return std::make_unique<OptimalStrategy>(std::move(advisor));
+    }};
+
+    std::vector<std::unique_ptr<Strategy>>  strategies;
+    std::vector<GameEngine>                 engines;
+
+    for (unsigned t{0}; t < threads; ++t)
+    {
+        strategies.push_back(make_strategy());
+        if (!strategies.back())
+        {
+            std::fprintf(stderr, "cannot read %s\n", column_path.c_str());
+            return EXIT_FAILURE;
+        }
+        engines.emplace_back(seed, engine);
+    }
+
+    constexpr std::uint64_t     chunk{256};
+    std::atomic<std::uint64_t>  next{0};
+    std::vector<Results>        results(threads);
+    std::vector<std::thread>    pool;
+
+    auto    worker{[&](unsigned t)
+    {
+        auto   &result{results[t]};
+
+        for (std::uint64_t first{next.fetch_add(chunk)}; first < games; first = next.fetch_add(chunk))
+        {
+            const auto  last{std::min(first + chunk, games)};
+
+            for (auto g{first}; g < last; ++g)
+                result.add(Results::Game{play(engines[t], *strategies[t], seed, g), g});
+            result.games += last - first;
+        }
+    }};
+
+    const auto  start{std::chrono::steady_clock::now()};
+
+    for (unsigned t{1}; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &t : pool)
+        t.join();
+
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+    Results total;
+
+    for (const auto &result : results)
+        total.merge(result);
+    if (games == 0)
+        return EXIT_SUCCESS;
+
+    const auto &histogram{total.histogram};
+    double      sum{0.0};
+    double      sum_squares{0.0};
+
+    for (size_t score{0}; score < histogram.size(); ++score)
+    {
+        const auto  count{static_cast<double>(histogram[score])};
+
+        sum += count * static_cast<double>(score);
+        sum_squares += count * static_cast<double>(score) * static_cast<double>(score);
+    }
+
+    const double    mean{sum / static_cast<double>(games)};
+    const double    stddev{std::sqrt(std::max(0.0, sum_squares / static_cast<double>(games) - mean * mean))};
+
+    std::printf("strategy:   %s\n", strategy_name.c_str());
+    std::printf("games:      %llu on %u threads in %.2f s\n", static_cast<unsigned long long>(games), threads, elapsed.count());
+    std::printf("throughput: %.0f games/s\n", static_cast<double>(games) / elapsed.count());
+    std::printf("mean:       %.2f\n", mean);
+    std::printf("stddev:     %.2f\n", stddev);
+    std::printf("min:        %d (game %llu)\n", total.lowest.score, static_cast<unsigned long long>(total.lowest.id));
+    std::printf("p10:        %d\n", percentile(histogram, games, 0.10));
+    std::printf("median:     %d\n", percentile(histogram, games, 0.50));
+    std::printf("p90:        %d\n", percentile(histogram, games, 0.90));
+    std::printf("max:        %d (game %llu)\n", total.highest.score, static_cast<unsigned long long>(total.highest.id));
+    std::printf("seed:       %llu (replay a game with: tripleytz --seed %llu --rng %s --game <id>)\n",
+                static_cast<unsigned long long>(seed), static_cast<unsigned long long>(seed), rng_name.c_str());
+
+    // Print the distribution in buckets of 100 points, scaled to the largest bucket.
+    constexpr size_t            bucket{100};
+    std::vector<std::uint64_t>  buckets((histogram.size() + bucket - 1) / bucket);
+
+    for (size_t score{0}; score < histogram.size(); ++score)
+        buckets[score / bucket] += histogram[score];
+
+    const auto  largest{*std::max_element(buckets.begin(), buckets.end())};
+    const auto  first{static_cast<size_t>(percentile(histogram, games, 0.0)) / bucket};
+
+    std::printf("\n");
+    for (size_t b{first}; b < buckets.size(); ++b)
+    {
+        const int   width{static_cast<int>(50 * buckets[b] / largest)};
+
+        std::printf("%5zu-%-5zu %10llu %.*s\n", b * bucket, b * bucket + bucket - 1,
+                    static_cast<unsigned long long>(buckets[b]), width,
+                    "##################################################");
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+/**************************************************************************
+* Copyright (c) 2023 by Jeff Bienstadt                                    *
+*                                                                         *
+* This file is part of the tripleytz project.                             *
+*                                                                         *
+* tripleytz is free software: you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by    *
+* the Free Software Foundation, either version 3 of the License, or       *
+* (at your option) any later version.                                     *
+*                                                                         *
+* tripleytz is distributed in the hope that it will be useful, but        *
+* WITHOUT ANY WARRANTY; without even the implied warranty of              *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+* General Public License for more details.                                *
+*                                                                         *
+* You should have received a copy of the GNU General Public License along *
+* with tripleytz. If not, see <https://www.gnu.org/licenses/>.            *
+**************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include "columnsolver.h"
+#include "triplesolver.h"
+
+namespace {
+void usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-j threads] [--triple seconds] [--triple-file file] [--memory megabytes] <column-file>\n"
+                 "  -j threads          number of threads, default one per hardware thread\n"
+                 "  --triple seconds    refine the Triple Yahtzee strategy for this long\n"
+                 "  --triple-file file  strategy file for the refined Triple values, default triple.tbl beside the column file;\n"
+                 "                      refinement continues from the values already in it\n"
+                 "  --memory megabytes  memory budget for refined Triple state values, default 256\n",
+                 program);
+}
+}   // anonymous namespace
+
+///
+/// \brief Compute the optimal single-column strategy and write its value table,
+///        then optionally refine the Triple Yahtzee strategy built from it.
+///
+int main(int argc, char *argv[])
+{
+    unsigned    threads{0};
+    double      triple_seconds{0.0};
+    size_t      memory_mb{256};
+    std::string path;
+    std::string triple_path;
+
+    for (int i{1}; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--triple") == 0 && i + 1 < argc)
+            triple_seconds = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--triple-file") == 0 && i + 1 < argc)
+            triple_path = argv[++i];
+        else if (std::strcmp(argv[i], "--memory") == 0 && i + 1 < argc)
+            memory_mb = std::strtoul(argv[++i], nullptr, 10);
+        else if (argv[i][0] != '-' && path.empty())
+            path = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (path.empty())
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (triple_path.empty())
+        triple_path = std::filesystem::path{path}.replace_filename("triple.tbl").string();
+
+    ColumnSolver    column;
+
+    auto    start{std::chrono::steady_clock::now()};
+    column.solve(threads);
+    std::chrono::duration<double>   elapsed{std::chrono::steady_clock::now() - start};
+
+    std::printf("expected column score: %.4f\n", column.expected_score());
+    std::printf("solved in %.2f s\n", elapsed.count());
+
+    if (!column.save(path))
+    {
+        std::fprintf(stderr, "cannot write %s\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (triple_seconds > 0.0)
+    {
+        TripleSolver        triple{column, memory_mb << 20};
+        std::atomic<bool>   stop{false};
+        std::thread         timer{[&]()
+        {
+            std::this_thread::sleep_for(std::chrono::duration<double>{triple_seconds});
+            stop = true;
+        }};
+
+        if (triple.load(triple_path))
+            std::printf("continuing from %s\n", triple_path.c_str());
+        std::printf("approximate Triple score: %.4f\n", triple.approximate_value(TripleState{}));
+
+        start = std::chrono::steady_clock::now();
+        const size_t    games{triple.solve(threads, stop, std::chrono::steady_clock::now().time_since_epoch().count())};
+        elapsed = std::chrono::steady_clock::now() - start;
+        timer.join();
+
+        std::printf("refined Triple score: %.4f\n", triple.value(TripleState{}));
+        std::printf("%zu games, %zu states refined in %.2f s\n", games, triple.cached_states(), elapsed.count());
+
+        if (!triple.save(triple_path))
+        {
+            std::fprintf(stderr, "cannot write %s\n", triple_path.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}